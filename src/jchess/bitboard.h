@@ -108,6 +108,27 @@ namespace jchess {
             return init;
         }
 
+        constexpr std::array<Bitboard, 8> initialise_adjacent_file_bbs() {
+            std::array<Bitboard, 8> init{};
+            for (int i = 0; i < 8; ++i) {
+                init[i] = ((i > A) ? FILE_A_BB << (i - 1) : 0ull) | ((i < H) ? FILE_A_BB << (i + 1) : 0ull);
+            }
+            return init;
+        }
+
+        // all ranks strictly in front of the given rank, from the point of view of color.
+        constexpr std::array<Bitboard, 8> initialise_forward_rank_bbs(Color color) {
+            std::array<Bitboard, 8> init{};
+            for (int rank = 0; rank < 8; ++rank) {
+                for (int other = 0; other < 8; ++other) {
+                    if ((color == WHITE) ? other > rank : other < rank) {
+                        init[rank] |= RANK_1_BB << 8 * other;
+                    }
+                }
+            }
+            return init;
+        }
+
         constexpr std::array<std::array<Bitboard, 64>, 8> initialise_ray_bbs() {
             std::array<std::array<Bitboard, 64>, 8> init{};
             for(Square sq=A1; sq<NUM_SQUARES; ++sq) {
@@ -232,6 +253,13 @@ namespace jchess {
     inline constexpr std::array<Bitboard, 15> DIAG_BBS {detail::initialise_diag_bbs()};
     inline constexpr std::array<Bitboard, 15> ANTI_DIAG_BBS {detail::initialise_anti_diag_bbs()};
 
+    inline constexpr std::array<Bitboard, 8> ADJACENT_FILE_BBS {detail::initialise_adjacent_file_bbs()};
+    // usage FORWARD_RANK_BBS[WHITE][RANK_3] gives ranks 4-8
+    inline constexpr std::array<Bitboard, 8> FORWARD_RANK_BBS[2] {
+        detail::initialise_forward_rank_bbs(WHITE),
+        detail::initialise_forward_rank_bbs(BLACK)
+    };
+
     inline constexpr Bitboard pawn_start_bb[2] {RANK_BBS[RANK_2], RANK_BBS[RANK_7]}; // PST_WHITE, PST_BLACK
     inline constexpr Bitboard back_rank_bb[2] {RANK_BBS[RANK_8], RANK_BBS[RANK_1]}; // PST_WHITE, PST_BLACK
 
@@ -246,7 +274,37 @@ namespace jchess {
         detail::compute_all_pawn_attacks(BLACK)
     };
 
-    constexpr inline RectTable RECTANGLE_BETWEEN {detail::initialise_rectangle_between()};
+    namespace detail {
+        constexpr std::array<Bitboard, 64> compute_all_forward_file_bbs(Color color) {
+            std::array<Bitboard, 64> init{};
+            for(Square sq=A1; sq<NUM_SQUARES; ++sq) {
+                init[sq] = FORWARD_RANK_BBS[color][rank_of(sq)] & FILE_BBS[file_of(sq)];
+            }
+            return init;
+        }
+
+        constexpr std::array<Bitboard, 64> compute_all_pawn_attack_spans(Color color) {
+            std::array<Bitboard, 64> init{};
+            for(Square sq=A1; sq<NUM_SQUARES; ++sq) {
+                init[sq] = FORWARD_RANK_BBS[color][rank_of(sq)] & ADJACENT_FILE_BBS[file_of(sq)];
+            }
+            return init;
+        }
+    } // namespace detail
+
+    // squares in front of a pawn on its own file, and on the adjacent files (every square it could ever attack).
+    // a pawn is passed when no enemy pawns are in the union of the two.
+    constexpr inline std::array<Bitboard, 64> FORWARD_FILE_BBS[2] {
+        detail::compute_all_forward_file_bbs(WHITE),
+        detail::compute_all_forward_file_bbs(BLACK)
+    };
+    constexpr inline std::array<Bitboard, 64> PAWN_ATTACK_SPANS[2] {
+        detail::compute_all_pawn_attack_spans(WHITE),
+        detail::compute_all_pawn_attack_spans(BLACK)
+    };
+
+    // written out by the attack_tables generator from detail::initialise_rectangle_between, see src/misc/attack_table_gen.cpp.
+    extern const RectTable RECTANGLE_BETWEEN;
 
     // helpers that don't have to be used at compile time to initialise magic tables:
 
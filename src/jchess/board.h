@@ -32,13 +32,24 @@ namespace jchess {
             assert(pos > 0);
             --pos;
         }
+
+        constexpr void clear() {
+            pos = 0;
+        }
+
+        constexpr int size() const {
+            return pos;
+        }
+
+        constexpr const T& operator[](int index) const {
+            assert(0 <= index && index < pos);
+            return data[index];
+        }
     private:
         std::array<T, detail::MAX_MOVES_IN_GAME> data;
         int pos = 0;
     };
 
-    using PrevStateStack = MoveInfoStack<BoardState>;
-
     struct GameState {
         GameState() : GameState(FEN(starting_fen)) {}
         GameState(FEN const& fen);
@@ -48,11 +59,41 @@ namespace jchess {
         auto operator<=>(GameState const& other) const = default;
     };
 
-    using PrevGameStateStack = MoveInfoStack<GameState>;
+    // what make_move can't recover from the position after the move, so it can be undone in place.
+    struct UndoInfo {
+        Move move;
+        Piece captured = NO_PIECE;
+        int castle_right_mask = 0;
+        std::optional<Square> enp_square;
+        int half_moves = 0;
+    };
+
+    // a piece that was moved, added or removed by a move, NUM_SQUARES stands for off the board.
+    struct DirtyPiece {
+        Piece piece = NO_PIECE;
+        Square from = NUM_SQUARES;
+        Square to = NUM_SQUARES;
+    };
+
+    // the pieces changed by one move, at most three for a capture promotion.
+    struct DirtyPieces {
+        int num = 0;
+        std::array<DirtyPiece, 3> pieces;
+        void add(Piece piece, Square from, Square to) { pieces[num++] = {piece, from, to}; }
+    };
 
     GameState get_game_state_after_move(Board const& board, Move const& move);
     BoardState get_state_after_move(BoardState const& current, Move const& move);
-    std::optional<CastleBits> get_move_castle_type(BoardState const& state, Move const& move);
+    // returns the captured piece, if any.
+    Piece make_move_in_place(BoardState& state, Move const& move);
+    void unmake_move_in_place(BoardState& state, UndoInfo const& undo);
+    std::optional<CastleBits> get_move_castle_type(Move const& move);
+    DirtyPieces get_dirty_pieces(BoardState const& current, Move const& move);
+
+    // fills in the move flags, which need the position to tell e.g. that e1g1 is castling.
+    Move move_from_squares(BoardState const& state, Square source, Square dest, std::optional<PieceType> promotion_type = std::nullopt);
+    // "0000" is the null move, throws std::invalid_argument on a malformed move.
+    Move move_from_uci(BoardState const& state, std::string const& uci_move);
 
     class Board {
     public:
@@ -60,17 +101,38 @@ namespace jchess {
         Board(FEN const& fen) { set_position(fen); }
         void set_position(FEN const& fen);
         void make_move(Move const& move);
-        void generate_legal_moves(MoveVector& moves, GenPolicy policy = GenPolicy::LEGAL);
+        void generate_legal_moves(MoveVector& moves, GenType type = GenType::ALL);
+        // cheaper, but each move has to pass is_legal before it is made.
+        void generate_pseudo_legal_moves(MoveVector& moves, GenType type = GenType::ALL);
+        // for a pseudo-legal move, whether it leaves our king safe.
+        bool is_legal(Move const& move) const;
+        // whether generate_pseudo_legal_moves could have given the move, for moves that come from elsewhere
+        // e.g. a transposition table or killer slot, without generating anything.
+        bool is_pseudo_legal(Move const& move) const;
         bool unmake_move();
         std::string to_string();
         GameState const& get_game_state() const { return game_state; }
         BoardState const& get_board_state() const { return board_state; }
         Color get_side_to_move() const { return game_state.side_to_move; }
-        bool in_check() const { return board_state.in_check(game_state.side_to_move); }
+        bool in_check() const { return get_check_info().checkers != 0ull; }
+        // computed on first use in each position.
+        AttackInfo const& get_attack_info() const;
+        // the same without enemy_attacks filled in.
+        AttackInfo const& get_check_info() const;
+        bool gives_check(Move const& move) const;
         bool is_50_move_draw() const { return game_state.half_moves >= 100; }
         int get_num_pieces() const;
         int get_num_pawns() const;
         bool can_enp_capture() const;
+        // number of moves made since the position was set.
+        int get_ply() const { return undo_stack.size(); }
+        // pieces changed by the move that led to the position at ply, for ply >= 1.
+        DirtyPieces const& get_dirty_pieces(int ply) const { return dirty_pieces[ply - 1]; }
+        // unique for every position reached, so a cached accumulator for a ply can be checked to still be valid.
+        uint64_t get_position_id(int ply) const { return position_ids[ply]; }
+        // zobrist key of the position, only castling, en passant and the side to move are added on top
+        // of the incrementally updated BoardState::piece_key.
+        uint64_t get_key() const;
         friend bool operator==(Board const& lhs, Board const& rhs) {
             return lhs.game_state == rhs.game_state && lhs.board_state == rhs.board_state;
         }
@@ -78,12 +140,19 @@ namespace jchess {
         GameState game_state;
         BoardState board_state;
         MoveGenerator movegen;
+        mutable AttackInfo attack_info;
+        mutable bool attack_info_valid = false;
+        mutable bool enemy_attacks_valid = false;
     private:
-        // TODO: should do incremental update instead, only store half moves and castling rights
-        PrevStateStack prev_board_states;
-        PrevGameStateStack prev_game_states;
+        MoveInfoStack<UndoInfo> undo_stack;
+        // for incremental nnue updates.
+        MoveInfoStack<DirtyPieces> dirty_pieces;
+        MoveInfoStack<uint64_t> position_ids;
+        uint64_t last_position_id = 0;
     };
 
+    Move move_from_uci(Board const& board, std::string const& uci_move);
+
     class ZobristHasher {
     public:
         ZobristHasher(const uint64_t *hash_values, int piece_start, int castle_start, int enp_start, int turn_start)
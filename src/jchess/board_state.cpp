@@ -1,6 +1,7 @@
 #include "board_state.h"
 #include "bitboard.h"
 #include "moves.h"
+#include "zobrist.h"
 
 #include <bit>
 #include <numeric>
@@ -27,31 +28,26 @@ namespace jchess {
         enp_square = fen.enp_square;
         std::fill(pieces.begin(), pieces.end(), NO_PIECE);
         for(const auto& [square, piece] : fen.pieces) {
-            if(type_from_piece(piece) == KING) {
-                king_sq[color_from_piece(piece)] = square;
-            }
-            pieces[square] = piece;
-            bb_add_square(piece_bbs[piece], square);
+            place_piece_on_square(piece, square);
         }
-        color_bbs[WHITE] = std::reduce(piece_bbs.begin(), piece_bbs.begin() + 6, 0ull, std::bit_or<uint64_t>{});
-        color_bbs[BLACK] = std::reduce(piece_bbs.begin() + 6, piece_bbs.end(), 0ull, std::bit_or<uint64_t>{});
-        orth_slider_bb[WHITE] = piece_bbs[W_QUEEN] | piece_bbs[W_ROOK];
-        orth_slider_bb[BLACK] = piece_bbs[B_QUEEN] | piece_bbs[B_ROOK];
-        diag_slider_bb[WHITE] = piece_bbs[W_QUEEN] | piece_bbs[W_BISHOP];
-        diag_slider_bb[BLACK] = piece_bbs[B_QUEEN] | piece_bbs[B_BISHOP];
-        all_pieces_bb = color_bbs[WHITE] | color_bbs[BLACK];
     }
 
     void BoardState::remove_piece_from_square(Square square) {
         Piece piece = pieces[square];
         if(piece != NO_PIECE) {
             Color piece_color = color_from_piece(piece);
+            PieceType type = type_from_piece(piece);
             bb_remove_square(all_pieces_bb, square);
             bb_remove_square(color_bbs[piece_color], square);
-            bb_remove_square(piece_bbs[piece], square);
-            // if not a slider, we aren't doing anything.
-            bb_remove_square(orth_slider_bb[piece_color], square);
-            bb_remove_square(diag_slider_bb[piece_color], square);
+            bb_remove_square(type_bbs[type], square);
+            material_key ^= material_count_key(piece, std::popcount(piece_bb(type, piece_color)));
+            psqt.mg -= PIECE_SQUARE_TABLE[piece][square].mg;
+            psqt.eg -= PIECE_SQUARE_TABLE[piece][square].eg;
+            phase -= PHASE_INC[piece];
+            piece_key ^= zobrist_piece_key(piece, square);
+            if(type == PAWN) {
+                pawn_key ^= zobrist_piece_key(piece, square);
+            }
             pieces[square] = NO_PIECE;
         }
     }
@@ -59,18 +55,20 @@ namespace jchess {
     void BoardState::place_piece_on_square(Piece piece, Square square) {
         Color piece_color = color_from_piece(piece);
         PieceType type = type_from_piece(piece);
+        material_key ^= material_count_key(piece, std::popcount(piece_bb(type, piece_color)));
         bb_add_square(all_pieces_bb, square);
         bb_add_square(color_bbs[piece_color], square);
-        bb_add_square(piece_bbs[piece], square);
-        if(type == QUEEN || type == ROOK) {
-            bb_add_square(orth_slider_bb[piece_color], square);
-        }
-        if(type == QUEEN || type == BISHOP) {
-            bb_add_square(diag_slider_bb[piece_color], square);
-        }
+        bb_add_square(type_bbs[type], square);
+        psqt.mg += PIECE_SQUARE_TABLE[piece][square].mg;
+        psqt.eg += PIECE_SQUARE_TABLE[piece][square].eg;
+        phase += PHASE_INC[piece];
         if(type == KING) {
             king_sq[piece_color] = square;
         }
+        piece_key ^= zobrist_piece_key(piece, square);
+        if(type == PAWN) {
+            pawn_key ^= zobrist_piece_key(piece, square);
+        }
         pieces[square] = piece;
     }
     bool is_attack(Square src, Square dest, PieceType type, Color color, BoardState const& state) {
@@ -91,11 +89,17 @@ namespace jchess {
     }
 
     Bitboard get_attackers_of(Square square, BoardState const &state, Color color) {
-        Bitboard knights = KNIGHT_ATTACKS[square] & state.piece_bbs[KNIGHT | color];
-        Bitboard ortho = get_rook_moves(square, 0ull, state.all_pieces_bb) & state.orth_slider_bb[color];
-        Bitboard diag = get_bishop_moves(square, 0ull, state.all_pieces_bb) & state.diag_slider_bb[color];
-        Bitboard pawn = PAWN_ATTACKS[!color][square] & state.piece_bbs[PAWN | color];
-        return knights | ortho | diag | pawn;
+        return get_attackers_of(square, state, color, state.all_pieces_bb);
+    }
+
+    Bitboard get_attackers_of(Square square, BoardState const &state, Color color, Bitboard occupied) {
+        Bitboard knights = KNIGHT_ATTACKS[square] & state.piece_bb(KNIGHT, color);
+        Bitboard ortho = get_rook_moves(square, 0ull, occupied) & state.orth_sliders(color);
+        Bitboard diag = get_bishop_moves(square, 0ull, occupied) & state.diag_sliders(color);
+        Bitboard pawn = PAWN_ATTACKS[!color][square] & state.piece_bb(PAWN, color);
+        // never a checker, but it still covers the squares around it for our king.
+        Bitboard king = KING_ATTACKS[square] & state.piece_bb(KING, color);
+        return knights | ortho | diag | pawn | king;
     }
 
     bool BoardState::in_check(Color color) const {
@@ -1,34 +1,50 @@
 #pragma once
 
 #include "core.h"
+#include "psqt.h"
 #include <compare>
 
 namespace jchess {
-    struct BoardState {
+    // copied and touched at every node, so it is kept to three cache lines: the bitboards movegen reads
+    // the most come first, then the one byte per square mailbox, then the incrementally updated eval terms.
+    struct alignas(64) BoardState {
         BoardState() : BoardState(FEN(starting_fen)) {}
         BoardState(FEN const& fen);
         BoardState(BoardState const& other) = default;
         BoardState& operator=(BoardState const& other) = default;
         void remove_piece_from_square(Square square);
         void place_piece_on_square(Piece piece, Square square);
-        int castle_right_mask = WHITE_QS | WHITE_KS | BLACK_QS | BLACK_KS;
-        std::optional<Square> enp_square;
-        std::array<Piece, 64> pieces;
-        std::array<Bitboard, 12> piece_bbs = {}; // one for white pawns, black kings etc.
+        Bitboard piece_bb(PieceType type, Color color) const { return type_bbs[type] & color_bbs[color]; }
+        Bitboard piece_bb(Piece piece) const { return piece_bb(type_from_piece(piece), color_from_piece(piece)); }
+        Bitboard orth_sliders(Color color) const { return (type_bbs[ROOK] | type_bbs[QUEEN]) & color_bbs[color]; }
+        Bitboard diag_sliders(Color color) const { return (type_bbs[BISHOP] | type_bbs[QUEEN]) & color_bbs[color]; }
+        Bitboard all_pieces_bb = 0;
         std::array<Bitboard, 2> color_bbs = {}; // all white and black pieces
-        Bitboard orth_slider_bb[2] = {}; // white/black rooks and queens
-        Bitboard diag_slider_bb[2] = {}; // white/black bishops and queens
+        std::array<Bitboard, 6> type_bbs = {}; // pawns, rooks etc. of both colors
+        std::array<Piece, 64> pieces;
+        uint64_t piece_key = 0; // zobrist key of every piece, kept up to date by place/remove.
+        uint64_t pawn_key = 0; // the same for the pawns only.
+        uint64_t material_key = 0; // zobrist key of the piece counts, ignoring where the pieces are.
+        TaperedScore psqt {}; // sum of PIECE_SQUARE_TABLE over the pieces, from white's point of view.
+        int16_t phase = 0; // sum of PHASE_INC over the pieces, can exceed detail::MAX_PHASE after promotions.
+        uint8_t castle_right_mask = WHITE_QS | WHITE_KS | BLACK_QS | BLACK_KS;
+        std::optional<Square> enp_square;
         Square king_sq[2] = {}; // white/black king squares
-        Bitboard all_pieces_bb = 0;
         bool in_check(Color color) const;
         bool operator==(const BoardState& other) const {
-            return (piece_bbs == other.piece_bbs) && enp_square == other.enp_square;
+            // everything else is derived from these.
+            return type_bbs == other.type_bbs && color_bbs == other.color_bbs &&
+                castle_right_mask == other.castle_right_mask && enp_square == other.enp_square;
         }
     };
 
+    static_assert(sizeof(BoardState) == 192, "BoardState should fit in three cache lines");
+
     bool is_attack(Square src, Square dest, PieceType type, Color color, BoardState const& state);
 
     Bitboard get_attackers_of(Square square, BoardState const& state, Color color);
+    // as if the sliders saw through the occupancy given instead, e.g. with a piece about to move taken off.
+    Bitboard get_attackers_of(Square square, BoardState const& state, Color color, Bitboard occupied);
 
     bool can_castle(BoardState const& state, Color color, bool queen_side, Bitboard attacked);
 }
\ No newline at end of file
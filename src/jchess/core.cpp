@@ -70,11 +70,6 @@ namespace jchess {
         }
         return static_cast<PieceType>(offset);
     }
-    PieceType type_from_piece(Piece piece) {
-        assert(piece != NO_PIECE);
-        return static_cast<PieceType>((piece > 5) ? piece - 6 : piece);
-    }
-
     Piece piece_from(PieceType type, Color color) {
         return static_cast<Piece>(type + ((color == BLACK) ? 6 : 0));
     }
@@ -92,11 +87,6 @@ namespace jchess {
         return static_cast<char>(tolower(piece_chars[type]));
     }
 
-    Color color_from_piece(Piece piece) {
-        assert(piece != NO_PIECE);
-        return (piece < 6) ? WHITE : BLACK;
-    }
-
     CastleBits castle_bits_from_char(char c) {
         switch(c) {
             case 'K':
@@ -160,30 +150,15 @@ namespace jchess {
         full_moves = std::stoi(fields[5]);
     }
 
-    Move::Move(const std::string &uci_move) {
-        // castling is sent as if e1g1 so this does handle castling
-        if(uci_move.size() > 5 || uci_move.size() < 4) {
-            throw std::invalid_argument("uci move string is wrong length");
-        }
-        if(uci_move == "0000") {
-            is_null_move = true;
-        } else {
-            source = square_from_alg_not(uci_move.substr(0, 2));
-            dest = square_from_alg_not(uci_move.substr(2, 2));
-            if(uci_move.size() == 5) {
-                promotion_type = piece_type_from_char(uci_move[4]);
-            }
-        }
-    }
-
     std::string move_to_string(Move const& move) {
-        if(move.is_null_move) {
+        if(move.is_null_move()) {
             return "0000";
         }
-        std::string res = square_to_string(move.source);
-        res += square_to_string(move.dest);
-        if(move.promotion_type.has_value()) {
-            res += char_from_piece_type(move.promotion_type.value());
+        // castling is sent as the king move, e.g. e1g1, which is how it is stored anyway.
+        std::string res = square_to_string(move.source());
+        res += square_to_string(move.dest());
+        if(auto promotion = move.promotion_type()) {
+            res += char_from_piece_type(promotion.value());
         }
         return res;
     }
@@ -6,6 +6,8 @@
 #include <optional>
 #include <stack>
 #include <array>
+#include <cstdint>
+#include <cassert>
 
 
 namespace jchess {
@@ -26,9 +28,10 @@ namespace jchess {
         return (color == WHITE) ? BLACK : WHITE;
     }
 
-    enum PieceType { PAWN, ROOK, KNIGHT, BISHOP, KING, QUEEN };
+    // the enums stored per square are a byte each, so BoardState stays compact.
+    enum PieceType : uint8_t { PAWN, ROOK, KNIGHT, BISHOP, KING, QUEEN };
 
-    enum Piece {
+    enum Piece : uint8_t {
         W_PAWN, W_ROOK, W_KNIGHT, W_BISHOP, W_KING, W_QUEEN,
         B_PAWN, B_ROOK, B_KNIGHT, B_BISHOP, B_KING, B_QUEEN,
         NO_PIECE = 12
@@ -40,12 +43,18 @@ namespace jchess {
 
     constexpr Color other_color(Color color) { return (color == WHITE) ? BLACK : WHITE; }
     bool is_slider(Piece piece);
-    PieceType type_from_piece(Piece piece);
+    constexpr PieceType type_from_piece(Piece piece) {
+        assert(piece != NO_PIECE);
+        return static_cast<PieceType>((piece > 5) ? piece - 6 : piece);
+    }
     Piece piece_from_char(char c);
     PieceType piece_type_from_char(char c);
     char char_from_piece(Piece piece);
     char char_from_piece_type(PieceType type);
-    Color color_from_piece(Piece piece);
+    constexpr Color color_from_piece(Piece piece) {
+        assert(piece != NO_PIECE);
+        return (piece < 6) ? WHITE : BLACK;
+    }
 
     // values need to be contiguous as used to lookup in an array.
     enum Direction {
@@ -64,7 +73,7 @@ namespace jchess {
     enum File { A, B, C, D, E, F, G, H };
     enum Rank { RANK_1, RANK_2, RANK_3, RANK_4, RANK_5, RANK_6, RANK_7, RANK_8 };
 
-    enum Square {
+    enum Square : uint8_t {
         A1, B1, C1, D1, E1, F1, G1, H1,
         A2, B2, C2, D2, E2, F2, G2, H2,
         A3, B3, C3, D3, E3, F3, G3, H3,
@@ -106,6 +115,13 @@ namespace jchess {
         return ypos1 > ypos2 ? ypos1 - ypos2 : ypos2 - ypos1;
     }
 
+    // number of king moves between the squares
+    constexpr int square_distance(Square sq1, Square sq2) {
+        int hdist = horizontal_distance(sq1, sq2);
+        int vdist = vertical_distance(sq1, sq2);
+        return hdist > vdist ? hdist : vdist;
+    }
+
     constexpr bool check_rank_file(int rank, int file) {
         return A <= file && file <= H && 0 <= rank && rank <= 7;
     }
@@ -153,16 +169,42 @@ namespace jchess {
         std::vector<std::pair<Square, Piece>> read_fen_pieces(std::string const& pieces);
     };
 
-    struct Move {
-        Move(const char *uci_move) : Move(std::string(uci_move)) {}
-        Move(std::string const& uci_move);
-        Move(Square source, Square dest) : source{source}, dest{dest} {}
-        Move(Square source, Square dest, std::optional<PieceType> promotion_type) : source{source}, dest{dest}, promotion_type{promotion_type} {}
-        Square source;
-        Square dest;
-        std::optional<PieceType> promotion_type;
-        bool is_null_move = false;
+    // anything about a move that would otherwise need the board to work out when making it.
+    enum MoveFlag { NORMAL_MOVE, PROMOTION, EN_PASSANT, CASTLING };
+
+    namespace detail {
+        constexpr PieceType promotion_types[4] = {KNIGHT, BISHOP, ROOK, QUEEN};
+        constexpr int promotion_index[6] = {0, 2, 0, 1, 0, 3}; // indexed by PieceType
+    }
+
+    // packed into 16 bits: source (6) | dest (6) | promotion type (2) | flag (2). A1A1 is the null move.
+    // a move only makes sense for the position it was generated in, use move_from_uci to read one.
+    class Move {
+    public:
+        constexpr Move() = default;
+        constexpr Move(Square source, Square dest, MoveFlag flag = NORMAL_MOVE)
+            : data(static_cast<uint16_t>(source | (dest << 6) | (flag << 14))) {}
+        constexpr Move(Square source, Square dest, PieceType promotion_type)
+            : data(static_cast<uint16_t>(source | (dest << 6) | (detail::promotion_index[promotion_type] << 12) | (PROMOTION << 14))) {}
+        constexpr Square source() const { return static_cast<Square>(data & 0x3F); }
+        constexpr Square dest() const { return static_cast<Square>((data >> 6) & 0x3F); }
+        constexpr MoveFlag flag() const { return static_cast<MoveFlag>(data >> 14); }
+        constexpr std::optional<PieceType> promotion_type() const {
+            if(flag() != PROMOTION) {
+                return std::nullopt;
+            }
+            return detail::promotion_types[(data >> 12) & 0x3];
+        }
+        constexpr bool is_null_move() const { return data == 0; }
+        constexpr uint16_t raw() const { return data; }
+        constexpr bool operator==(Move const& other) const = default;
+    private:
+        uint16_t data = 0;
     };
 
+    static_assert(sizeof(Move) == 2);
+
+    constexpr Move NULL_MOVE {};
+
     std::string move_to_string(Move const& move);
 }
\ No newline at end of file
@@ -1,7 +1,9 @@
 #include "engine.h"
 #include "search_limits.h"
+#include "perft.h"
 
 #include <iostream>
+#include <filesystem>
 #include <fstream>
 #include <thread> // sleep_until
 #include <sstream>
@@ -16,6 +18,9 @@ namespace jchess {
             .opening_book_file = "./data/baron30.bin",
             .endgame_table_dir = "./tables/",
             .nnue_network_file = "./data/nn-04a843f8932e.nnue",
+            .nnue_image_file = "./data/nn-04a843f8932e.img",
+            // no halfkp_128x2 network has been trained yet, SmallNet is offered once this names one.
+            .nnue_small_network_file = "",
             .endgame_dtz_depth = 5
         };
 
@@ -40,6 +45,16 @@ namespace jchess {
             return flags;
         }
 
+        // the image of the network if one has been generated, it loads faster
+        std::string default_nnue_network(EngineConfig const& config) {
+            bool use_image = !config.nnue_image_file.empty() && std::filesystem::exists(config.nnue_image_file);
+            return use_image ? config.nnue_image_file : config.nnue_network_file;
+        }
+
+        bool has_small_network(EngineConfig const& config) {
+            return !config.nnue_small_network_file.empty() && std::filesystem::exists(config.nnue_small_network_file);
+        }
+
         auto engine_logger = spdlog::basic_logger_mt("engine_logger", "./logs/engine.txt", true);
     }
 
@@ -80,12 +95,23 @@ namespace jchess {
         }
         if(feature_flags & FF_NNUE_EVAL) {
             spdlog::info("nnue evaluation enabled");
-            try {
-                auto nnue_eval = std::make_unique<nnue_eval::NNUEEvaluator>(config.nnue_network_file);
-                searcher.enable_nnue_eval(std::move(nnue_eval));
-            } catch(std::runtime_error& err) {
-                spdlog::warn("failed to load NNUE network file, using fallback eval: {0}", err.what());
+            load_nnue_network(default_nnue_network(config));
+        }
+    }
+
+    bool Engine::load_nnue_network(std::string const& network_file) {
+        try {
+            auto nnue_eval = std::make_unique<nnue_eval::NNUEEvaluator>(network_file);
+            nnue_simd_level = nnue_eval->get_simd_level();
+            if(nnue_eval->is_network_mapped()) {
+                spdlog::info("nnue network mapped from {0}", network_file);
             }
+            spdlog::info("nnue evaluation using {0}, {1}", nnue_eval::simd_level_name(*nnue_simd_level), nnue_eval->get_architecture());
+            searcher.enable_nnue_eval(std::move(nnue_eval));
+            return true;
+        } catch(std::runtime_error& err) {
+            spdlog::warn("failed to load NNUE network file {0}, using fallback eval: {1}", network_file, err.what());
+            return false;
         }
     }
 
@@ -101,6 +127,15 @@ namespace jchess {
                 thread_safe_line_out("id author FooBar");
                 oss <<  "option name OwnBook type check default " << ((feature_flags & FF_OPENING_BOOK) ? "true" : "false");
                 thread_safe_line_out(oss.str());
+                if(feature_flags & FF_NNUE_EVAL) {
+                    if(has_small_network(config)) {
+                        thread_safe_line_out("option name SmallNet type check default false");
+                    }
+                    thread_safe_line_out("option name LazyEvalMargin type spin default " + std::to_string(DEFAULT_LAZY_EVAL_MARGIN) + " min 0 max 100000");
+                }
+                if(nnue_simd_level) {
+                    thread_safe_line_out(std::string("info string nnue evaluation using ") + std::string(nnue_eval::simd_level_name(*nnue_simd_level)));
+                }
                 thread_safe_line_out("uciok");
                 break;
             case UciNoArgCmd::ISREADY:
@@ -120,11 +155,23 @@ namespace jchess {
     void Engine::handle_uci_position(jchess::UciPosition const& pos) {
         board = Board{pos.position};
         for(std::string const& move_str : pos.moves) {
-            board.make_move(Move{move_str});
+            board.make_move(move_from_uci(board, move_str));
         }
     }
 
     void Engine::handle_uci_go(jchess::UciGo const& go) {
+        if(go.perft > 0) {
+            // the same divide output as stockfish, so the two can be compared move by move.
+            stop_search_if_running();
+            PerftResult result = perft_divide(board, go.perft);
+            for(auto const& [move, nodes] : result.divide) {
+                thread_safe_line_out(move_to_string(move) + ": " + std::to_string(nodes));
+            }
+            thread_safe_line_out("");
+            thread_safe_line_out("Nodes searched: " + std::to_string(result.nodes));
+            return;
+        }
+
         bool must_search = !go.search_moves.empty() || go.infinite;
 
         // we are so far into the endgame that we can lookup moves in a table rather than search
@@ -154,7 +201,7 @@ namespace jchess {
         // we need to do a manual search as can't lookup the current position
         stop_search_if_running();
         SearchLimits limits;
-        limits_from_uci_go(limits, go, board.get_side_to_move());
+        limits_from_uci_go(limits, go, board);
         // new thread per search, inefficient: revisit this
         search_thread = std::thread(&Searcher::search_mt, &searcher, std::ref(board), limits);
     }
@@ -168,6 +215,20 @@ namespace jchess {
             } else {
                 feature_flags &= ~FF_OPENING_BOOK;
             }
+        } else if(cmd.name == "SmallNet" && (feature_flags & FF_NNUE_EVAL) && has_small_network(config)) {
+            // a faster but weaker network, for short time controls
+            stop_search_if_running();
+            if(cmd.value == "true") {
+                load_nnue_network(config.nnue_small_network_file);
+            } else {
+                load_nnue_network(default_nnue_network(config));
+            }
+        } else if(cmd.name == "LazyEvalMargin") {
+            try {
+                searcher.set_lazy_eval_margin(std::stoi(cmd.value));
+            } catch(std::exception& err) {
+                spdlog::warn("invalid LazyEvalMargin: {0}", cmd.value);
+            }
         }
     }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <thread>
 
 #include "uci.h"
@@ -23,6 +24,8 @@ namespace jchess {
         std::string opening_book_file;
         std::string endgame_table_dir;
         std::string nnue_network_file;
+        std::string nnue_image_file; // used instead of the network file if it exists, see nnue_image_gen
+        std::string nnue_small_network_file; // used with the SmallNet option, which is only offered if this exists
         int endgame_dtz_depth;
     };
 
@@ -40,12 +43,14 @@ namespace jchess {
         FeatureFlags feature_flags = 0ull;
         Board board {};
         Searcher searcher {};
-        Move best_move {"0000"};
+        Move best_move = NULL_MOVE;
         int search_limit = 0;
         polyglot::PGMappedBook book {};
         bool out_of_book = false;
         std::unique_ptr<syzgy::SZEndgameTables> endgame_tables = nullptr;
         std::thread search_thread;
+        std::optional<nnue_eval::SimdLevel> nnue_simd_level {};
         void stop_search_if_running();
+        bool load_nnue_network(std::string const& network_file);
     };
 }
\ No newline at end of file
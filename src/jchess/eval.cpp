@@ -1,35 +1,56 @@
 #include "eval.h"
-#include "temp_eval.h"
-#include <bit>
+
+#include <algorithm>
 
 namespace jchess {
     namespace {
-        constexpr int PAWN_VAL = 100;
-        constexpr int BISHOP_VAL = 300;
-        constexpr int KNIGHT_VAL = 300;
-        constexpr int ROOK_VAL = 500;
-        constexpr int QUEEN_VAL = 900;
+        // the material is folded into the piece square tables, which the board state keeps up to date.
+        TaperedScore material_and_piece_square(BoardState const& state, Color color) {
+            return (color == WHITE) ? state.psqt : TaperedScore{-state.psqt.mg, -state.psqt.eg};
+        }
+
+        TaperedScore pawn_structure(PawnEntry& pawns, BoardState const& state, Color color) {
+            int mg = pawns.score[color].mg - pawns.score[!color].mg;
+            int eg = pawns.score[color].eg - pawns.score[!color].eg;
+            // the king only needs sheltering while there are pieces around to attack it.
+            mg += pawns.king_shelter(state, color) - pawns.king_shelter(state, !color);
+            return {mg, eg};
+        }
+
+        Score eval_from_entries(Board const& board, PawnEntry& pawns, MaterialEntry const& material) {
+            Color color = board.get_side_to_move();
+            BoardState const& state = board.get_board_state();
+            if(material.has_endgame_eval()) {
+                return material.endgame_eval(state, color);
+            }
+            TaperedScore psqt = material_and_piece_square(state, color);
+            TaperedScore structure = pawn_structure(pawns, state, color);
+            int phase = std::min<int>(state.phase, detail::MAX_PHASE); // a promotion can take it over the max
+            Score score = ((psqt.mg + structure.mg) * phase + (psqt.eg + structure.eg) * (detail::MAX_PHASE - phase)) / detail::MAX_PHASE;
+            score += (color == WHITE) ? material.imbalance : -material.imbalance;
+            Color ahead = (score > 0) ? color : !color;
+            return score * material.scale_factor(state, ahead) / detail::SCALE_NORMAL;
+        }
     }
+
     Score eval(Board const& board) {
-        Color color = board.get_side_to_move();
         BoardState const& state = board.get_board_state();
-        // maybe do this in temp_eval so easier to get rid of later.
-        if(!temp_eval::done_init) {
-            temp_eval::init_tables();
-            temp_eval::done_init = true;
-        }
-
-        // material
-        int npawn = std::popcount(state.piece_bbs[PAWN | color]) - std::popcount(state.piece_bbs[PAWN | !color]);
-        int nbishop = std::popcount(state.piece_bbs[BISHOP | color]) - std::popcount(state.piece_bbs[BISHOP | !color]);
-        int nknight = std::popcount(state.piece_bbs[KNIGHT | color]) - std::popcount(state.piece_bbs[KNIGHT | !color]);
-        int nrook = std::popcount(state.piece_bbs[ROOK | color]) - std::popcount(state.piece_bbs[ROOK | !color]);
-        int nqueen = std::popcount(state.piece_bbs[QUEEN | color]) - std::popcount(state.piece_bbs[QUEEN | !color]);
+        PawnEntry pawns;
+        compute_pawn_entry(pawns, state);
+        MaterialEntry material;
+        compute_material_entry(material, state);
+        return eval_from_entries(board, pawns, material);
+    }
 
-        Score material = npawn * PAWN_VAL + nbishop * BISHOP_VAL + nknight * KNIGHT_VAL + nrook * ROOK_VAL + nqueen * QUEEN_VAL;
+    Score eval(Board const& board, PawnHashTable& pawn_table) {
+        BoardState const& state = board.get_board_state();
+        MaterialEntry material;
+        compute_material_entry(material, state);
+        return eval_from_entries(board, pawn_table.probe(state), material);
+    }
 
-        // temp eval doesn't bother to consider material, it's positional only.
-        Score piece_square = temp_eval::eval(state.pieces, color);
-        return material + piece_square;
+    Score eval(Board const& board, PawnHashTable& pawn_table, MaterialHashTable& material_table) {
+        BoardState const& state = board.get_board_state();
+        return eval_from_entries(board, pawn_table.probe(state), material_table.probe(state));
     }
 }
@@ -1,9 +1,15 @@
 #pragma once
 
 #include "board.h"
+#include "material.h"
+#include "pawns.h"
 
 namespace jchess {
     using Score = int;
     // eval scores are given in centipawns
     Score eval(Board const& board);
-}
\ No newline at end of file
+    // same as above, but looks up the pawn structure terms in the table rather than computing them.
+    Score eval(Board const& board, PawnHashTable& pawn_table);
+    // same as above, also using the material table for the imbalance and any specialised endgame eval.
+    Score eval(Board const& board, PawnHashTable& pawn_table, MaterialHashTable& material_table);
+}
@@ -0,0 +1,103 @@
+#include "magic_bitboard.h"
+
+#include <bit>
+#include <stdexcept>
+#include <string>
+
+#if (defined(__x86_64__) || defined(_M_X64)) && !defined(__BMI2__)
+#define JCHESS_PEXT_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace jchess {
+    namespace {
+        bool pext_tables_built = false;
+
+        // the portable equivalent of _pext_u64, only used to build the tables.
+        Bitboard software_pext(Bitboard source, Bitboard mask) {
+            Bitboard result = 0ull;
+            for (Bitboard bit = 1ull; mask; bit <<= 1) {
+                if (source & mask & -mask) {
+                    result |= bit;
+                }
+                mask &= mask - 1;
+            }
+            return result;
+        }
+
+        template <size_t Entries>
+        void build_pext_table(std::array<Bitboard, Entries>& attacks, std::array<uint32_t, 64>& offsets,
+                              std::array<Bitboard, 64> const& masks, Bitboard (*compute_attacks)(Bitboard, Square)) {
+            uint32_t offset = 0;
+            for (Square square = A1; square < NUM_SQUARES; ++square) {
+                offsets[square] = offset;
+                Bitboard blockers = 0ull;
+                do {
+                    attacks[offset + software_pext(blockers, masks[square])] = compute_attacks(blockers, square);
+                    blockers = (blockers - masks[square]) & masks[square];
+                } while (blockers);
+                offset += 1u << std::popcount(masks[square]);
+            }
+        }
+
+        void build_pext_tables() {
+            if (pext_tables_built) {
+                return;
+            }
+            build_pext_table(detail::BISHOP_PEXT_ATTACKS, detail::BISHOP_PEXT_OFFSETS, detail::BISHOP_BLOCKER_MASKS, detail::compute_blocked_bishop_attacks);
+            build_pext_table(detail::ROOK_PEXT_ATTACKS, detail::ROOK_PEXT_OFFSETS, detail::ROOK_BLOCKER_MASKS, detail::compute_blocked_rook_attacks);
+            pext_tables_built = true;
+        }
+    }
+
+#ifdef JCHESS_PEXT_DISPATCH
+    namespace detail {
+        __attribute__((target("bmi2"))) Bitboard pext_bishop_attacks(Square source, Bitboard blockers) {
+            return BISHOP_PEXT_ATTACKS[BISHOP_PEXT_OFFSETS[source] + _pext_u64(blockers, BISHOP_BLOCKER_MASKS[source])];
+        }
+
+        __attribute__((target("bmi2"))) Bitboard pext_rook_attacks(Square source, Bitboard blockers) {
+            return ROOK_PEXT_ATTACKS[ROOK_PEXT_OFFSETS[source] + _pext_u64(blockers, ROOK_BLOCKER_MASKS[source])];
+        }
+    }
+#elif !defined(__BMI2__)
+    namespace detail {
+        // never selected, slider_backend_available says no, but the header still needs the symbols.
+        Bitboard pext_bishop_attacks(Square source, Bitboard blockers) {
+            return BISHOP_PEXT_ATTACKS[BISHOP_PEXT_OFFSETS[source] + software_pext(blockers, BISHOP_BLOCKER_MASKS[source])];
+        }
+
+        Bitboard pext_rook_attacks(Square source, Bitboard blockers) {
+            return ROOK_PEXT_ATTACKS[ROOK_PEXT_OFFSETS[source] + software_pext(blockers, ROOK_BLOCKER_MASKS[source])];
+        }
+    }
+#endif
+
+    std::string_view slider_backend_name(SliderBackend backend) {
+        return backend == SliderBackend::PEXT ? "pext" : "magic";
+    }
+
+    bool slider_backend_available(SliderBackend backend) {
+        if (backend == SliderBackend::MAGIC) {
+            return true;
+        }
+#if defined(__BMI2__)
+        return true;
+#elif defined(JCHESS_PEXT_DISPATCH)
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("bmi2");
+#else
+        return false;
+#endif
+    }
+
+    void set_slider_backend(SliderBackend backend) {
+        if (!slider_backend_available(backend)) {
+            throw std::runtime_error(std::string("slider attacks: backend not available: ") + std::string(slider_backend_name(backend)));
+        }
+        if (backend == SliderBackend::PEXT) {
+            build_pext_tables();
+        }
+        detail::use_pext_attacks = backend == SliderBackend::PEXT;
+    }
+}
\ No newline at end of file
@@ -2,43 +2,29 @@
 
 #include "core.h"
 #include "bitboard.h"
+#include "magics.h"
 #include <vector>
 #include <array>
+#include <string_view>
 
-namespace jchess {
-    namespace detail {
-        constexpr size_t MAX_BISHOP_TBL_SZ = 512;
-        constexpr size_t MAX_ROOK_TBL_SZ = 4096;
-
-        // https://www.chessprogramming.org/Looking_for_Magics
-        constexpr uint64_t rook_magics[64] = {0xa8002c000108020ULL, 0x6c00049b0002001ULL, 0x100200010090040ULL, 0x2480041000800801ULL, 0x280028004000800ULL, 0x900410008040022ULL, 0x280020001001080ULL, 0x2880002041000080ULL, 0xa000800080400034ULL, 0x4808020004000ULL, 0x2290802004801000ULL, 0x411000d00100020ULL, 0x402800800040080ULL, 0xb000401004208ULL, 0x2409000100040200ULL, 0x1002100004082ULL, 0x22878001e24000ULL, 0x1090810021004010ULL, 0x801030040200012ULL, 0x500808008001000ULL, 0xa08018014000880ULL, 0x8000808004000200ULL, 0x201008080010200ULL, 0x801020000441091ULL, 0x800080204005ULL, 0x1040200040100048ULL, 0x120200402082ULL, 0xd14880480100080ULL, 0x12040280080080ULL, 0x100040080020080ULL, 0x9020010080800200ULL, 0x813241200148449ULL, 0x491604001800080ULL, 0x100401000402001ULL, 0x4820010021001040ULL, 0x400402202000812ULL, 0x209009005000802ULL, 0x810800601800400ULL, 0x4301083214000150ULL, 0x204026458e001401ULL, 0x40204000808000ULL, 0x8001008040010020ULL, 0x8410820820420010ULL, 0x1003001000090020ULL, 0x804040008008080ULL, 0x12000810020004ULL, 0x1000100200040208ULL, 0x430000a044020001ULL, 0x280009023410300ULL, 0xe0100040002240ULL, 0x200100401700ULL, 0x2244100408008080ULL, 0x8000400801980ULL, 0x2000810040200ULL, 0x8010100228810400ULL, 0x2000009044210200ULL, 0x4080008040102101ULL, 0x40002080411d01ULL, 0x2005524060000901ULL, 0x502001008400422ULL, 0x489a000810200402ULL, 0x1004400080a13ULL, 0x4000011008020084ULL, 0x26002114058042ULL};
-        constexpr uint64_t bishop_magics[64] = {0x89a1121896040240ULL, 0x2004844802002010ULL, 0x2068080051921000ULL, 0x62880a0220200808ULL, 0x4042004000000ULL, 0x100822020200011ULL, 0xc00444222012000aULL, 0x28808801216001ULL, 0x400492088408100ULL, 0x201c401040c0084ULL, 0x840800910a0010ULL, 0x82080240060ULL, 0x2000840504006000ULL, 0x30010c4108405004ULL, 0x1008005410080802ULL, 0x8144042209100900ULL, 0x208081020014400ULL, 0x4800201208ca00ULL, 0xf18140408012008ULL, 0x1004002802102001ULL, 0x841000820080811ULL, 0x40200200a42008ULL, 0x800054042000ULL, 0x88010400410c9000ULL, 0x520040470104290ULL, 0x1004040051500081ULL, 0x2002081833080021ULL, 0x400c00c010142ULL, 0x941408200c002000ULL, 0x658810000806011ULL, 0x188071040440a00ULL, 0x4800404002011c00ULL, 0x104442040404200ULL, 0x511080202091021ULL, 0x4022401120400ULL, 0x80c0040400080120ULL, 0x8040010040820802ULL, 0x480810700020090ULL, 0x102008e00040242ULL, 0x809005202050100ULL, 0x8002024220104080ULL, 0x431008804142000ULL, 0x19001802081400ULL, 0x200014208040080ULL, 0x3308082008200100ULL, 0x41010500040c020ULL, 0x4012020c04210308ULL, 0x208220a202004080ULL, 0x111040120082000ULL, 0x6803040141280a00ULL, 0x2101004202410000ULL, 0x8200000041108022ULL, 0x21082088000ULL, 0x2410204010040ULL, 0x40100400809000ULL, 0x822088220820214ULL, 0x40808090012004ULL, 0x910224040218c9ULL, 0x402814422015008ULL, 0x90014004842410ULL, 0x1000042304105ULL, 0x10008830412a00ULL, 0x2520081090008908ULL, 0x40102000a0a60140ULL};
-
-        using BishopAttacks = std::array<std::array<Bitboard, MAX_BISHOP_TBL_SZ>, 64>;
-        using RookAttacks = std::array<std::array<Bitboard, MAX_ROOK_TBL_SZ>, 64>;
-
-        constexpr int RBits[64] = {
-            12, 11, 11, 11, 11, 11, 11, 12,
-            11, 10, 10, 10, 10, 10, 10, 11,
-            11, 10, 10, 10, 10, 10, 10, 11,
-            11, 10, 10, 10, 10, 10, 10, 11,
-            11, 10, 10, 10, 10, 10, 10, 11,
-            11, 10, 10, 10, 10, 10, 10, 11,
-            11, 10, 10, 10, 10, 10, 10, 11,
-            12, 11, 11, 11, 11, 11, 11, 12
-        };
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
 
-        constexpr int BBits[64] = {
-            6, 5, 5, 5, 5, 5, 5, 6,
-            5, 5, 5, 5, 5, 5, 5, 5,
-            5, 5, 7, 7, 7, 7, 5, 5,
-            5, 5, 7, 9, 9, 7, 5, 5,
-            5, 5, 7, 9, 9, 7, 5, 5,
-            5, 5, 7, 7, 7, 7, 5, 5,
-            5, 5, 5, 5, 5, 5, 5, 5,
-            6, 5, 5, 5, 5, 5, 5, 6
-        };
+namespace jchess {
+    // how slider attacks are looked up. PEXT indexes the tables with the bmi2 instruction instead of
+    // a magic multiply and shift, which is faster on cpus where pext is fast (Intel, AMD from Zen 3).
+    enum class SliderBackend { MAGIC, PEXT };
+
+    std::string_view slider_backend_name(SliderBackend backend);
+    bool slider_backend_available(SliderBackend backend);
+    // chosen at startup, pext when built with JCHESS_BMI2 and magic otherwise. a build without it can still
+    // switch to pext on a bmi2 cpu, but the lookup is then an out of line call.
+    inline SliderBackend get_slider_backend();
+    // not thread safe, only call this when nothing is searching. throws if the cpu can't use the backend.
+    void set_slider_backend(SliderBackend backend);
 
+    namespace detail {
         constexpr void blocker_mask_bb_edges(Bitboard &bb, Square square) {
             auto [rank, file] = rank_file_from_square(square);
             if (rank != RANK_1) {
@@ -107,29 +93,65 @@ namespace jchess {
             return attacks;
         }
 
-        constexpr uint64_t get_bishop_index(Bitboard blockers, Square square) {
-            uint64_t index = blockers * bishop_magics[square];
-            int n = BBits[square];
-            index >>= (64 - n);
-            return index;
+        constexpr std::array<Bitboard, 64> initialise_blocker_masks(Bitboard (*get_mask)(Square)) {
+            std::array<Bitboard, 64> masks{};
+            for (Square square = A1; square < NUM_SQUARES; ++square) {
+                masks[square] = get_mask(square);
+            }
+            return masks;
+        }
+
+        inline constexpr std::array<Bitboard, 64> BISHOP_BLOCKER_MASKS{initialise_blocker_masks(get_bishop_blocker_mask)};
+        inline constexpr std::array<Bitboard, 64> ROOK_BLOCKER_MASKS{initialise_blocker_masks(get_rook_blocker_mask)};
+
+        // everything a lookup needs for one square, so it only touches one line besides the attack itself.
+        // each square owns 2^bits entries of one packed table, starting at offset.
+        struct Magic {
+            Bitboard mask;
+            uint64_t magic;
+            uint32_t offset;
+            uint32_t shift;
+
+            constexpr size_t index(Bitboard blockers) const {
+                return offset + (((blockers & mask) * magic) >> shift);
+            }
+        };
+
+        constexpr size_t packed_table_size(int const (&bits)[64]) {
+            size_t size = 0;
+            for (int square_bits : bits) {
+                size += size_t{1} << square_bits;
+            }
+            return size;
         }
 
-        constexpr uint64_t get_rook_index(Bitboard blockers, Square square) {
-            uint64_t index = blockers * rook_magics[square];
-            int n = RBits[square];
-            index >>= (64 - n);
-            return index;
+        constexpr size_t BISHOP_TBL_SZ = packed_table_size(BBits);
+        constexpr size_t ROOK_TBL_SZ = packed_table_size(RBits);
+
+        using BishopAttacks = std::array<Bitboard, BISHOP_TBL_SZ>;
+        using RookAttacks = std::array<Bitboard, ROOK_TBL_SZ>;
+
+        constexpr std::array<Magic, 64> initialise_magics(std::array<Bitboard, 64> const& masks, uint64_t const (&magics)[64], int const (&bits)[64]) {
+            std::array<Magic, 64> entries{};
+            uint32_t offset = 0;
+            for (Square square = A1; square < NUM_SQUARES; ++square) {
+                entries[square] = {masks[square], magics[square], offset, static_cast<uint32_t>(64 - bits[square])};
+                offset += 1u << bits[square];
+            }
+            return entries;
         }
 
+        inline constexpr std::array<Magic, 64> BISHOP_MAGICS{initialise_magics(BISHOP_BLOCKER_MASKS, bishop_magics, BBits)};
+        inline constexpr std::array<Magic, 64> ROOK_MAGICS{initialise_magics(ROOK_BLOCKER_MASKS, rook_magics, RBits)};
+
         constexpr BishopAttacks initialise_bishop_attacks() {
             BishopAttacks bishop_attacks{};
             for (Square square = A1; square < NUM_SQUARES; ++square) {
-                Bitboard blockers_mask = get_bishop_blocker_mask(square);
+                Bitboard blockers_mask = BISHOP_BLOCKER_MASKS[square];
                 // https://www.chessprogramming.org/Traversing_Subsets_of_a_Set
                 Bitboard blockers = 0ull;
                 do {
-                    uint64_t index = get_bishop_index(blockers, square);
-                    bishop_attacks[square][index] = compute_blocked_bishop_attacks(blockers, square);
+                    bishop_attacks[BISHOP_MAGICS[square].index(blockers)] = compute_blocked_bishop_attacks(blockers, square);
                     blockers = (blockers - blockers_mask) & blockers_mask;
                 } while (blockers);
             }
@@ -139,28 +161,68 @@ namespace jchess {
         constexpr RookAttacks initialise_rook_attacks() {
             RookAttacks rook_attacks{};
             for (Square square = A1; square < NUM_SQUARES; ++square) {
-                Bitboard blockers_mask = get_rook_blocker_mask(square);
+                Bitboard blockers_mask = ROOK_BLOCKER_MASKS[square];
                 Bitboard blockers = 0ull;
                 do {
-                    uint64_t index = get_rook_index(blockers, square);
-                    rook_attacks[square][index] = compute_blocked_rook_attacks(blockers, square);
+                    rook_attacks[ROOK_MAGICS[square].index(blockers)] = compute_blocked_rook_attacks(blockers, square);
                     blockers = (blockers - blockers_mask) & blockers_mask;
                 } while (blockers);
             }
             return rook_attacks;
         }
 
-        inline constexpr BishopAttacks BISHOP_ATTACKS{initialise_bishop_attacks()};
-        inline constexpr RookAttacks ROOK_ATTACKS{initialise_rook_attacks()};
+        // written out by the attack_tables generator from the initialisers above, see src/misc/attack_table_gen.cpp.
+        extern const BishopAttacks BISHOP_ATTACKS;
+        extern const RookAttacks ROOK_ATTACKS;
+
+        constexpr size_t BISHOP_PEXT_TBL_SZ = 5248; // one entry per blocker subset
+        constexpr size_t ROOK_PEXT_TBL_SZ = 102400;
+
+        // filled in by set_slider_backend the first time the pext backend is chosen.
+        inline std::array<Bitboard, BISHOP_PEXT_TBL_SZ> BISHOP_PEXT_ATTACKS{};
+        inline std::array<Bitboard, ROOK_PEXT_TBL_SZ> ROOK_PEXT_ATTACKS{};
+        inline std::array<uint32_t, 64> BISHOP_PEXT_OFFSETS{};
+        inline std::array<uint32_t, 64> ROOK_PEXT_OFFSETS{};
+        inline bool use_pext_attacks = false;
+
+#ifdef __BMI2__
+        // built for a bmi2 target, so the lookup can be inlined like the magic one.
+        inline Bitboard pext_bishop_attacks(Square source, Bitboard blockers) {
+            return BISHOP_PEXT_ATTACKS[BISHOP_PEXT_OFFSETS[source] + _pext_u64(blockers, BISHOP_BLOCKER_MASKS[source])];
+        }
+
+        inline Bitboard pext_rook_attacks(Square source, Bitboard blockers) {
+            return ROOK_PEXT_ATTACKS[ROOK_PEXT_OFFSETS[source] + _pext_u64(blockers, ROOK_BLOCKER_MASKS[source])];
+        }
+
+        // picks pext before main. it lives here rather than in magic_bitboard.cpp so every object that looks up
+        // attacks pulls the selection in, the linker drops an initialiser in an otherwise unreferenced archive
+        // member. anything looking up attacks earlier gets the magic tables.
+        inline const bool pext_backend_selected = [] {
+            set_slider_backend(SliderBackend::PEXT);
+            return true;
+        }();
+#else
+        Bitboard pext_bishop_attacks(Square source, Bitboard blockers);
+        Bitboard pext_rook_attacks(Square source, Bitboard blockers);
+#endif
     } // namespace detail
 
-    constexpr Bitboard get_bishop_attacks(Square source, Bitboard blockers) {
-        blockers = blockers & detail::get_bishop_blocker_mask(source);
-        return detail::BISHOP_ATTACKS[source][detail::get_bishop_index(blockers, source)];
+    inline SliderBackend get_slider_backend() {
+        return detail::use_pext_attacks ? SliderBackend::PEXT : SliderBackend::MAGIC;
     }
 
-    constexpr Bitboard get_rook_attacks(Square source, Bitboard blockers) {
-        blockers = blockers & detail::get_rook_blocker_mask(source);
-        return detail::ROOK_ATTACKS[source][detail::get_rook_index(blockers, source)];
+    inline Bitboard get_bishop_attacks(Square source, Bitboard blockers) {
+        if (detail::use_pext_attacks) {
+            return detail::pext_bishop_attacks(source, blockers);
+        }
+        return detail::BISHOP_ATTACKS[detail::BISHOP_MAGICS[source].index(blockers)];
+    }
+
+    inline Bitboard get_rook_attacks(Square source, Bitboard blockers) {
+        if (detail::use_pext_attacks) {
+            return detail::pext_rook_attacks(source, blockers);
+        }
+        return detail::ROOK_ATTACKS[detail::ROOK_MAGICS[source].index(blockers)];
     }
 }
\ No newline at end of file
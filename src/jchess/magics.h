@@ -0,0 +1,52 @@
+#pragma once
+
+// generated by src/misc/magic_finder.c (-a 1000000), don't edit by hand.
+// rook table: 102400 entries, bishop table: 5248 entries
+
+#include <cstdint>
+
+namespace jchess::detail {
+    constexpr uint64_t rook_magics[64] = {
+        0x2080088010204000ULL, 0x200102080410200ULL, 0x100104020000900ULL, 0x2100041002210008ULL, 0x200040200201008ULL, 0x1100010004000802ULL, 0x2800a0005000080ULL, 0x8100098250210002ULL,
+        0x148000a2804002ULL, 0x2401000200141ULL, 0x411001103200042ULL, 0x10800800801005ULL, 0x900808004000800ULL, 0x210009007c0006ULL, 0x2800800200010080ULL, 0x842001d40810402ULL,
+        0x1080084000200048ULL, 0x1030024040002000ULL, 0x121010010442000ULL, 0x1050024008040040ULL, 0x4012808008020400ULL, 0x808002000400ULL, 0x434040001224850ULL, 0x80200010040b4ULL,
+        0x400180008020ULL, 0x1000810300400260ULL, 0x1084100200010ULL, 0x2004200100824ULL, 0x4080080080800400ULL, 0x2400020080800400ULL, 0x2401010400080210ULL, 0x8a00420000a104ULL,
+        0x4220004000808000ULL, 0x4200886804000ULL, 0x20110041002000ULL, 0xa000801004800800ULL, 0x1800280081800400ULL, 0x1414000200800480ULL, 0x2080102804002241ULL, 0x9800004402002081ULL,
+        0x400800040028020ULL, 0x2a0200050044008ULL, 0x1401014020030018ULL, 0x808008010008009ULL, 0x191002800050050ULL, 0x8202001004020008ULL, 0x10015022040008ULL, 0xc184403820003ULL,
+        0x400408001082500ULL, 0x81008022005200ULL, 0x2810104200802200ULL, 0x8e50000901e100ULL, 0x4100080080040080ULL, 0x1400100440200801ULL, 0x2002000441480200ULL, 0x304c85040200ULL,
+        0x408208104144202ULL, 0x48030c4000201081ULL, 0x808104420010009ULL, 0x1000841001012009ULL, 0x2a26002038841012ULL, 0x7000204000801ULL, 0x8020110d004ULL, 0x8002080440102ULL
+    };
+
+    constexpr uint64_t bishop_magics[64] = {
+        0x4200400420440ULL, 0x104480801042800ULL, 0x104410c11000060ULL, 0x288084100100000ULL, 0x802021020100024ULL, 0xe002010420443802ULL, 0x1289004600800ULL, 0x210050300820ULL,
+        0x410400808011040ULL, 0x6002142c040045ULL, 0x2004040102120020ULL, 0x3110400800010ULL, 0x6040840420120020ULL, 0x491002100040ULL, 0x2084208088201208ULL, 0x1004211041142000ULL,
+        0x404080285004809dULL, 0x84006031040322ULL, 0x222001004001025ULL, 0x88001901410401ULL, 0x402000420210300ULL, 0x1008080304010405ULL, 0x880504882080ULL, 0x8c200c5030b1180ULL,
+        0x800208024050c441ULL, 0x2084022050104100ULL, 0x5040244100104c0ULL, 0x24004084010002ULL, 0x14840010802008ULL, 0x1958002012008c24ULL, 0xc092008880100ULL, 0x802200208200b208ULL,
+        0x108041082400220ULL, 0x12828a4800a10805ULL, 0x4202801040808ULL, 0x422200800048820ULL, 0x4024200040108ULL, 0x4080810008040ULL, 0x4040080041090ULL, 0x19428a480420040ULL,
+        0xa9100250212100ULL, 0x8040840109012000ULL, 0x220132005000ULL, 0x4200004200810800ULL, 0x204100c008080ULL, 0x2540014041000080ULL, 0x9010904002210ULL, 0x41c4042000044ULL,
+        0x804880818064008ULL, 0x4000808801100000ULL, 0x80400f0118290200ULL, 0x82000084240012ULL, 0x100001002020420ULL, 0x1020204302020340ULL, 0x40490800a08080ULL, 0x1245080200420000ULL,
+        0x6010101012050ULL, 0x2200008404028204ULL, 0x40414034020800ULL, 0x100000000228810ULL, 0x640290010421210ULL, 0x300402620140108ULL, 0x899122022008201ULL, 0x2002100202004200ULL
+    };
+
+    constexpr int RBits[64] = {
+        12, 11, 11, 11, 11, 11, 11, 12,
+        11, 10, 10, 10, 10, 10, 10, 11,
+        11, 10, 10, 10, 10, 10, 10, 11,
+        11, 10, 10, 10, 10, 10, 10, 11,
+        11, 10, 10, 10, 10, 10, 10, 11,
+        11, 10, 10, 10, 10, 10, 10, 11,
+        11, 10, 10, 10, 10, 10, 10, 11,
+        12, 11, 11, 11, 11, 11, 11, 12
+    };
+
+    constexpr int BBits[64] = {
+        6, 5, 5, 5, 5, 5, 5, 6,
+        5, 5, 5, 5, 5, 5, 5, 5,
+        5, 5, 7, 7, 7, 7, 5, 5,
+        5, 5, 7, 9, 9, 7, 5, 5,
+        5, 5, 7, 9, 9, 7, 5, 5,
+        5, 5, 7, 7, 7, 7, 5, 5,
+        5, 5, 5, 5, 5, 5, 5, 5,
+        6, 5, 5, 5, 5, 5, 5, 6
+    };
+}
\ No newline at end of file
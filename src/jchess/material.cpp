@@ -0,0 +1,179 @@
+#include "material.h"
+#include "bitboard.h"
+
+#include <bit>
+#include <cassert>
+
+namespace jchess {
+    namespace {
+        constexpr int PAWN_VAL = 100;
+        constexpr int BISHOP_VAL = 300;
+        constexpr int KNIGHT_VAL = 300;
+        constexpr int ROOK_VAL = 500;
+        constexpr int QUEEN_VAL = 900;
+
+        // well clear of any positional score, but well short of a checkmate score.
+        constexpr int KNOWN_WIN = 10000;
+
+        constexpr int BISHOP_PAIR_BONUS = 30;
+        // https://www.chessprogramming.org/Material#Imbalances knights get better and rooks worse with more pawns.
+        constexpr int KNIGHT_PAWN_ADJUST = 6;
+        constexpr int ROOK_PAWN_ADJUST = -12;
+
+        int count(BoardState const& state, PieceType type, Color color) {
+            return std::popcount(state.piece_bb(type, color));
+        }
+
+        int non_pawn_material(BoardState const& state, Color color) {
+            return count(state, KNIGHT, color) * KNIGHT_VAL + count(state, BISHOP, color) * BISHOP_VAL
+                + count(state, ROOK, color) * ROOK_VAL + count(state, QUEEN, color) * QUEEN_VAL;
+        }
+
+        bool is_bare_king(BoardState const& state, Color color) {
+            return state.color_bbs[color] == bb_from_square(state.king_sq[color]);
+        }
+
+        // the mating side wants the other king on the edge of the board, and its own king close to it.
+        int push_to_edge(Square square) {
+            int rank = rank_of(square), file = file_of(square);
+            int from_edge = std::min(rank, RANK_8 - rank) + std::min(file, H - file);
+            return 60 - 10 * from_edge;
+        }
+
+        int push_close(Square sq1, Square sq2) {
+            return 70 - 10 * square_distance(sq1, sq2);
+        }
+
+        int evaluate_draw(BoardState const&, Color, Color) {
+            return 0;
+        }
+
+        // lone king against enough material to force mate.
+        int evaluate_kxk(BoardState const& state, Color strong_side, Color) {
+            Square weak_king = state.king_sq[!strong_side];
+            Square strong_king = state.king_sq[strong_side];
+            int score = non_pawn_material(state, strong_side) + count(state, PAWN, strong_side) * PAWN_VAL;
+            score += push_to_edge(weak_king) + push_close(strong_king, weak_king);
+            return KNOWN_WIN + score;
+        }
+
+        // king and pawn against king, without a bitbase only the clear cut cases are recognised.
+        int evaluate_kpk(BoardState const& state, Color strong_side, Color side_to_move) {
+            Square pawn = lsb_square_from_bb(state.piece_bb(PAWN, strong_side));
+            Square weak_king = state.king_sq[!strong_side];
+            Square strong_king = state.king_sq[strong_side];
+            int relative_rank = (strong_side == WHITE) ? rank_of(pawn) : RANK_8 - rank_of(pawn);
+            int score = PAWN_VAL + 5 * relative_rank;
+
+            // rule of the square: the defending king can't catch the pawn, and nothing blocks it.
+            Square promotion = square_from_rank_file((strong_side == WHITE) ? RANK_8 : RANK_1, file_of(pawn));
+            int pawn_moves = RANK_8 - relative_rank - ((relative_rank == RANK_2) ? 1 : 0);
+            int king_moves = square_distance(weak_king, promotion) - ((side_to_move == strong_side) ? 0 : 1);
+            Bitboard pawn_path = FORWARD_FILE_BBS[strong_side][pawn];
+            if(king_moves > pawn_moves && !(pawn_path & bb_from_square(strong_king))) {
+                return KNOWN_WIN + score;
+            }
+            // once the defending king gets in front of a rook pawn it can never be shifted.
+            bool rook_pawn = file_of(pawn) == A || file_of(pawn) == H;
+            if(rook_pawn && (pawn_path & bb_from_square(weak_king))) {
+                return 0;
+            }
+            return score;
+        }
+
+        // without pawns, being up less than a rook is very rarely enough to win.
+        int scale_no_pawns(BoardState const& state, Color strong_side) {
+            if(non_pawn_material(state, strong_side) < ROOK_VAL) {
+                return 0;
+            }
+            return (non_pawn_material(state, !strong_side) <= BISHOP_VAL) ? 4 : 14;
+        }
+
+        int imbalance(BoardState const& state, Color color) {
+            int pawns_above_five = count(state, PAWN, color) - 5;
+            int value = (count(state, BISHOP, color) >= 2) ? BISHOP_PAIR_BONUS : 0;
+            value += count(state, KNIGHT, color) * pawns_above_five * KNIGHT_PAWN_ADJUST;
+            value += count(state, ROOK, color) * pawns_above_five * ROOK_PAWN_ADJUST;
+            return value;
+        }
+
+        // returns the endgame function for the side with the extra material, if there is a specialised one.
+        EndgameFunction find_endgame(BoardState const& state, Color strong_side) {
+            Color weak_side = !strong_side;
+            if(!is_bare_king(state, weak_side)) {
+                return nullptr;
+            }
+            int strong_pawns = count(state, PAWN, strong_side);
+            int strong_material = non_pawn_material(state, strong_side);
+            if(strong_pawns == 0 && strong_material == 2 * KNIGHT_VAL && count(state, KNIGHT, strong_side) == 2) {
+                return evaluate_draw; // KNNK, mate is possible but can't be forced
+            }
+            if(strong_material >= ROOK_VAL) {
+                return evaluate_kxk;
+            }
+            if(strong_pawns == 1 && strong_material == 0) {
+                return evaluate_kpk;
+            }
+            return nullptr;
+        }
+    }
+
+    void compute_material_entry(MaterialEntry& entry, BoardState const& state) {
+        entry = MaterialEntry{};
+        entry.key = state.material_key;
+
+        int minors = 0, rooks = 0, queens = 0;
+        for(Color color : {WHITE, BLACK}) {
+            minors += count(state, KNIGHT, color) + count(state, BISHOP, color);
+            rooks += count(state, ROOK, color);
+            queens += count(state, QUEEN, color);
+        }
+        entry.imbalance = imbalance(state, WHITE) - imbalance(state, BLACK);
+
+        // KK, KNK and KBK
+        int num_pawns = count(state, PAWN, WHITE) + count(state, PAWN, BLACK);
+        if(num_pawns == 0 && rooks == 0 && queens == 0 && minors <= 1) {
+            entry.insufficient_material = true;
+            entry.evaluate = evaluate_draw;
+            return;
+        }
+
+        for(Color color : {WHITE, BLACK}) {
+            EndgameFunction endgame = find_endgame(state, color);
+            if(endgame) {
+                entry.strong_side = color;
+                entry.evaluate = endgame;
+                return;
+            }
+        }
+
+        for(Color color : {WHITE, BLACK}) {
+            bool no_pawns = count(state, PAWN, color) == 0;
+            if(no_pawns && non_pawn_material(state, color) - non_pawn_material(state, !color) <= BISHOP_VAL) {
+                entry.scale[color] = scale_no_pawns;
+            }
+        }
+    }
+
+    int MaterialEntry::endgame_eval(BoardState const& state, Color side_to_move) const {
+        assert(evaluate != nullptr);
+        int score = evaluate(state, strong_side, side_to_move);
+        return (side_to_move == strong_side) ? score : -score;
+    }
+
+    int MaterialEntry::scale_factor(BoardState const& state, Color ahead) const {
+        return scale[ahead] ? scale[ahead](state, ahead) : detail::SCALE_NORMAL;
+    }
+
+    MaterialHashTable::MaterialHashTable(size_t num_entries) : entries(num_entries) {
+        assert(std::has_single_bit(num_entries));
+    }
+
+    MaterialEntry& MaterialHashTable::probe(BoardState const& state) {
+        MaterialEntry& entry = entries[state.material_key & (entries.size() - 1)];
+        if(entry.key != state.material_key) {
+            compute_material_entry(entry, state);
+        }
+        return entry;
+    }
+}
\ No newline at end of file
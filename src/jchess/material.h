@@ -0,0 +1,40 @@
+#pragma once
+
+#include "board_state.h"
+
+#include <vector>
+
+namespace jchess {
+    namespace detail {
+        constexpr size_t DEFAULT_MATERIAL_TABLE_ENTRIES = 1 << 13; // must be a power of 2
+        constexpr int SCALE_NORMAL = 64;
+    }
+
+    // specialised evaluation of an endgame, from the point of view of strong_side.
+    using EndgameFunction = int (*)(BoardState const& state, Color strong_side, Color side_to_move);
+    // out of detail::SCALE_NORMAL, applied to the regular eval when strong_side is ahead.
+    using ScaleFunction = int (*)(BoardState const& state, Color strong_side);
+
+    // everything about a position that only depends on how many of each piece there are.
+    struct MaterialEntry {
+        uint64_t key = 0;
+        int imbalance = 0; // from white's point of view
+        bool insufficient_material = false; // neither side can ever checkmate, e.g. KNK or KBK
+        Color strong_side = WHITE;
+        EndgameFunction evaluate = nullptr; // replaces the regular eval when set
+        ScaleFunction scale[2] = {};
+        bool has_endgame_eval() const { return evaluate != nullptr; }
+        int endgame_eval(BoardState const& state, Color side_to_move) const;
+        int scale_factor(BoardState const& state, Color ahead) const;
+    };
+
+    void compute_material_entry(MaterialEntry& entry, BoardState const& state);
+
+    class MaterialHashTable {
+    public:
+        explicit MaterialHashTable(size_t num_entries = detail::DEFAULT_MATERIAL_TABLE_ENTRIES);
+        MaterialEntry& probe(BoardState const& state);
+    private:
+        std::vector<MaterialEntry> entries;
+    };
+}
\ No newline at end of file
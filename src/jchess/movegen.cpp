@@ -1,22 +1,21 @@
 #include "movegen.h"
 #include "bitboard.h"
 #include "moves.h"
+#include "setwise_attacks.h"
 
 #include <bit>
 #include <cassert>
 
 namespace jchess {
     namespace {
-        void append_king_castle_moves(MoveVector &moves, BoardState const &state, Bitboard attacked, Color color) {
-            Square king_sq = (color == WHITE) ? E1 : E8;
-            if (can_castle(state, color, true, attacked)) { // queenside
-                Square king_dest = king_sq + WEST + WEST;
-                moves.emplace_back(king_sq, king_dest);
+        template <Color Us>
+        void append_king_castle_moves(MoveVector &moves, BoardState const &state, Bitboard attacked) {
+            constexpr Square king_sq = (Us == WHITE) ? E1 : E8;
+            if (can_castle(state, Us, true, attacked)) { // queenside
+                moves.emplace_back(king_sq, king_sq + WEST + WEST, CASTLING);
             }
-
-            if (can_castle(state, color, false, attacked)) { // kingside
-                Square king_dest = king_sq + EAST + EAST;
-                moves.emplace_back(king_sq, king_dest);
+            if (can_castle(state, Us, false, attacked)) { // kingside
+                moves.emplace_back(king_sq, king_sq + EAST + EAST, CASTLING);
             }
         }
 
@@ -27,210 +26,320 @@ namespace jchess {
             }
         }
 
-        Bitboard get_slider_and_knight_moves(
-            PieceType piece_type,
-            Square source,
-            Bitboard own_pieces,
-            Bitboard enemy_pieces
-            ) {
-            assert(piece_type != KING && piece_type != PAWN);
-            switch (piece_type) {
-                case KNIGHT:
-                    return get_knight_moves(source, own_pieces);
-                case ROOK:
-                    return get_rook_moves(source, own_pieces, enemy_pieces);
-                case BISHOP:
-                    return get_bishop_moves(source, own_pieces, enemy_pieces);
-                case QUEEN:
-                    return get_queen_moves(source, own_pieces, enemy_pieces);
-                default:
-                    assert(false);
+        // pawn moves that all moved by the same offset, source = dest - Offset.
+        template <Color Us, int Offset>
+        void append_pawn_moves_from_dest_bb(MoveVector &moves, Bitboard dest_bb) {
+            Bitboard promote = dest_bb & back_rank_bb[Us];
+            dest_bb &= ~promote;
+            Square dest;
+            while(pop_lsb_square(dest_bb, dest)) {
+                moves.emplace_back(static_cast<Square>(dest - Offset), dest);
+            }
+            while(pop_lsb_square(promote, dest)) {
+                for (PieceType promotion: {KNIGHT, BISHOP, ROOK, QUEEN}) {
+                    moves.emplace_back(static_cast<Square>(dest - Offset), dest, promotion);
+                }
             }
         }
 
-        bool in_check_after_enp(Square src, Square other_pawn, BoardState const &state, Color color) {
-            Bitboard blockers = state.all_pieces_bb;
-            blockers &= ~(bb_from_square(src) | bb_from_square(other_pawn));
-            Square king_sq = state.king_sq[color];
-            Bitboard checkers = get_rook_moves(king_sq, 0ull, blockers) & state.orth_slider_bb[other_color(color)];
-            return static_cast<bool>(checkers);
+        template <Color Us>
+        constexpr Bitboard pawn_push(Bitboard pawns) {
+            return (Us == WHITE) ? bb_north_one(pawns) : bb_south_one(pawns);
         }
 
-        bool can_enp_capture(BoardState const& state, Square checker_sq, Color color) {
-            return (type_from_piece(state.pieces[checker_sq]) == PAWN) &&
-                state.enp_square.has_value() &&
-                state.enp_square.value() + (color == WHITE ? SOUTH : NORTH) == checker_sq;
+        // captures towards the a file and towards the h file.
+        template <Color Us>
+        constexpr Bitboard pawn_west_captures(Bitboard pawns) {
+            return (Us == WHITE) ? bb_nwest_one(pawns) : bb_swest_one(pawns);
         }
-    } // anonymous namespace end
 
-    void MoveGenerator::get_legal_moves(MoveVector& moves, BoardState const& state, Color color, GenPolicy policy) {
-        Bitboard checkers = get_attackers_of(state.king_sq[color], state, !color);
-        int num_checkers = std::popcount(checkers);
+        template <Color Us>
+        constexpr Bitboard pawn_east_captures(Bitboard pawns) {
+            return (Us == WHITE) ? bb_neast_one(pawns) : bb_seast_one(pawns);
+        }
 
-        compute_dest_masks(state, color, checkers, policy); // handle all information about pins here
+        template <Color Us>
+        constexpr Bitboard all_pawn_attacks(Bitboard pawns) {
+            return pawn_west_captures<Us>(pawns) | pawn_east_captures<Us>(pawns);
+        }
 
-        if(policy != GenPolicy::ONLY_CAPTURES) {
-            get_king_non_castle_moves(moves, state, color);
+        template <PieceType Pt>
+        Bitboard get_slider_and_knight_moves(Square source, Bitboard own_pieces, Bitboard enemy_pieces) {
+            static_assert(Pt != KING && Pt != PAWN);
+            if constexpr (Pt == KNIGHT) {
+                return get_knight_moves(source, own_pieces);
+            } else if constexpr (Pt == ROOK) {
+                return get_rook_moves(source, own_pieces, enemy_pieces);
+            } else if constexpr (Pt == BISHOP) {
+                return get_bishop_moves(source, own_pieces, enemy_pieces);
+            } else {
+                return get_queen_moves(source, own_pieces, enemy_pieces);
+            }
         }
 
-        if (num_checkers >= 2) {
-            return; //. if in double check can only move the king.
+        // the whole line through two aligned squares, edge to edge.
+        Bitboard line_through(Square sq1, Square sq2) {
+            if (rank_of(sq1) == rank_of(sq2)) {
+                return RANK_BBS[rank_of(sq1)];
+            } else if (file_of(sq1) == file_of(sq2)) {
+                return FILE_BBS[file_of(sq1)];
+            } else if (diagonal_from_square(sq1) == diagonal_from_square(sq2)) {
+                return DIAG_BBS[diagonal_from_square(sq1)];
+            }
+            return ANTI_DIAG_BBS[antidiag_from_square(sq1)];
         }
 
-        if (num_checkers == 0 && policy != GenPolicy::ONLY_CAPTURES) {
-            // castling only possible if not in check
-            Bitboard attacked = get_all_attacked_squares(state, !color);
-            append_king_castle_moves(moves, state, attacked, color);
+        // our pieces standing between one of our sliders and the enemy king, moving one off the line checks.
+        template <Color Us>
+        Bitboard get_discovered_check_candidates(BoardState const& state) {
+            Square enemy_king = state.king_sq[!Us];
+            Bitboard own = state.color_bbs[Us];
+            Bitboard snipers = (xray_rook_moves(state.all_pieces_bb, own, enemy_king) & state.orth_sliders(Us)) |
+                               (xray_bishop_moves(state.all_pieces_bb, own, enemy_king) & state.diag_sliders(Us));
+            Bitboard candidates = 0ull;
+            Square sniper;
+            while(pop_lsb_square(snipers, sniper)) {
+                candidates |= RECTANGLE_BETWEEN[enemy_king][sniper] & own;
+            }
+            return candidates;
         }
+    } // anonymous namespace end
 
-        get_all_piece_moves(moves, KNIGHT, state, color);
-        get_all_piece_moves(moves, BISHOP, state, color);
-        get_all_piece_moves(moves, ROOK, state, color);
-        get_all_piece_moves(moves, QUEEN, state, color);
-        get_all_pawn_moves(moves, state, color);
+    AttackInfo compute_attack_info(BoardState const& state, Color color) {
+        AttackInfo info = compute_check_info(state, color);
+        info.enemy_attacks = get_all_attacked_squares(state, !color);
+        return info;
     }
 
-    void MoveGenerator::get_all_pawn_moves(MoveVector &moves, BoardState const &state, Color color) {
-        Bitboard pawns_bb = state.piece_bbs[PAWN | color];
-        while (pawns_bb) {
-            Square src = lsb_square_from_bb(pawns_bb);
-            Bitboard dests = get_pawn_moves(src, state, color);
-            Bitboard promote = back_rank_bb[color] & dests;
-            append_moves_from_dest_bb(moves, src, dests & ~promote);
-            Square dest;
-            while(pop_lsb_square(promote, dest)) {
-                PieceType promotions[4] {KNIGHT, BISHOP, ROOK, QUEEN};
-                for (PieceType promotion: promotions) {
-                    moves.emplace_back(src, dest, promotion);
-                }
-            }
-            pawns_bb &= pawns_bb - 1;
+    AttackInfo compute_check_info(BoardState const& state, Color color) {
+        AttackInfo info;
+        Square king_sq = state.king_sq[color];
+        Bitboard own = state.color_bbs[color];
+
+        // if we're in check, every piece can only capture the checker or move "in front" of it.
+        info.checkers = get_attackers_of(king_sq, state, !color);
+        info.check_mask = -1ull;
+        if(info.checkers) {
+            info.check_mask = info.checkers | RECTANGLE_BETWEEN[king_sq][lsb_square_from_bb(info.checkers)];
         }
-    }
 
-    Bitboard MoveGenerator::get_pawn_moves(Square square, BoardState const &state, Color color) {
-        Direction push_dir = (color == WHITE) ? NORTH : SOUTH;
-        Bitboard attacks = PAWN_ATTACKS[color][square] & state.color_bbs[!color];
-        Bitboard enp = 0ull;
-        if (state.enp_square.has_value()) {
-            Bitboard potential_enp = PAWN_ATTACKS[color][square] & bb_from_square(state.enp_square.value());
-            Square other_pawn = state.enp_square.value() + ((color == WHITE) ? SOUTH : NORTH);
-            // some obscure positions can move into check after enp
-            if (potential_enp && !in_check_after_enp(square, other_pawn, state, color)) {
-                enp = potential_enp;
-            }
+        // a slider seen from the king through exactly one of our pieces pins it.
+        Square pinner;
+        Bitboard orth_pinners = xray_rook_moves(state.all_pieces_bb, own, king_sq) & state.orth_sliders(!color);
+        while(pop_lsb_square(orth_pinners, pinner)) {
+            info.orth_pin_mask |= RECTANGLE_BETWEEN[king_sq][pinner] | bb_from_square(pinner);
         }
-        Bitboard push_one = bb_from_square(square + push_dir) & ~state.all_pieces_bb;
-        Bitboard push_two = 0ull;
-        if (push_one && (bb_from_square(square) & pawn_start_bb[color])) {
-            push_two = bb_from_square(square + push_dir + push_dir) & ~state.all_pieces_bb;
+        Bitboard diag_pinners = xray_bishop_moves(state.all_pieces_bb, own, king_sq) & state.diag_sliders(!color);
+        while(pop_lsb_square(diag_pinners, pinner)) {
+            info.diag_pin_mask |= RECTANGLE_BETWEEN[king_sq][pinner] | bb_from_square(pinner);
         }
-        return (attacks | enp | push_one | push_two) & allowed_dest_mask[square];
-    }
+        info.pinned = (info.orth_pin_mask | info.diag_pin_mask) & own;
 
-    void MoveGenerator::get_king_non_castle_moves(MoveVector& moves, BoardState const&state, Color color) {
-        Square king_sq = state.king_sq[color];
-        Bitboard potential_moves = KING_ATTACKS[king_sq];
-        Bitboard in_check = get_all_attacked_squares(state, !color);
-        Bitboard dests = potential_moves & ~(in_check | state.color_bbs[color]);
-        append_moves_from_dest_bb(moves, king_sq, dests);
+        Square enemy_king = state.king_sq[!color];
+        info.check_squares[PAWN] = PAWN_ATTACKS[!color][enemy_king];
+        info.check_squares[KNIGHT] = KNIGHT_ATTACKS[enemy_king];
+        info.check_squares[BISHOP] = get_bishop_attacks(enemy_king, state.all_pieces_bb);
+        info.check_squares[ROOK] = get_rook_attacks(enemy_king, state.all_pieces_bb);
+        info.check_squares[QUEEN] = info.check_squares[BISHOP] | info.check_squares[ROOK];
+        return info;
     }
 
-    Bitboard get_all_attacked_squares(BoardState const &state, Color color) {
-        Bitboard all_attacked = 0ull;
-
-        all_attacked |= KING_ATTACKS[state.king_sq[color]];
-        Bitboard pawns = state.piece_bbs[PAWN | color];
-        Bitboard knights = state.piece_bbs[KNIGHT | color];
-        Bitboard rooks = state.piece_bbs[ROOK | color];
-        Bitboard bishops = state.piece_bbs[BISHOP | color];
-        Bitboard queens = state.piece_bbs[QUEEN | color];
-        Square sq;
+    void MoveGenerator::get_legal_moves(MoveVector& moves, BoardState const& state, Color color, GenType type) {
+        get_legal_moves(moves, state, color, compute_attack_info(state, color), type);
+    }
 
-        // xray through the opponents king for purpose of correctly determining squares that are in check
-        Bitboard pieces_ignoring_king = state.all_pieces_bb & ~bb_from_square(state.king_sq[!color]);
-        while(pop_lsb_square(pawns, sq)) {
-            all_attacked |= PAWN_ATTACKS[color][sq];
+    void MoveGenerator::get_legal_moves(MoveVector& moves, BoardState const& state, Color color, AttackInfo const& info, GenType type) {
+        if (color == WHITE) {
+            dispatch<WHITE, true>(moves, state, info, type);
+        } else {
+            dispatch<BLACK, true>(moves, state, info, type);
         }
-        while(pop_lsb_square(rooks, sq)) {
-            all_attacked |= get_rook_moves(sq, 0ull, pieces_ignoring_king);
+    }
+
+    void MoveGenerator::get_pseudo_legal_moves(MoveVector& moves, BoardState const& state, Color color, AttackInfo const& info, GenType type) {
+        if (color == WHITE) {
+            dispatch<WHITE, false>(moves, state, info, type);
+        } else {
+            dispatch<BLACK, false>(moves, state, info, type);
         }
-        while(pop_lsb_square(knights, sq)) {
-            all_attacked |= get_knight_moves(sq, 0ull);
+    }
+
+    template <Color Us, bool Legal>
+    void MoveGenerator::dispatch(MoveVector& moves, BoardState const& state, AttackInfo const& info, GenType type) {
+        switch (type) {
+            case GenType::ALL:
+                return generate<Us, GenType::ALL, Legal>(moves, state, info);
+            case GenType::CAPTURES:
+                return generate<Us, GenType::CAPTURES, Legal>(moves, state, info);
+            case GenType::QUIETS:
+                return generate<Us, GenType::QUIETS, Legal>(moves, state, info);
+            case GenType::EVASIONS:
+                return generate<Us, GenType::EVASIONS, Legal>(moves, state, info);
+            case GenType::QUIET_CHECKS:
+                return generate<Us, GenType::QUIET_CHECKS, Legal>(moves, state, info);
         }
-        while(pop_lsb_square(bishops, sq)) {
-            all_attacked |= get_bishop_moves(sq, 0ull, pieces_ignoring_king);
+    }
+
+    template <Color Us, GenType Type, bool Legal>
+    void MoveGenerator::generate(MoveVector& moves, BoardState const& state, AttackInfo const& legal_info) {
+        // without the pin rays and enemy attacks every piece moves as if unpinned and the king anywhere,
+        // Board::is_legal sorts the moves out when they are searched.
+        AttackInfo pseudo_info;
+        if constexpr (!Legal) {
+            pseudo_info = legal_info;
+            pseudo_info.enemy_attacks = pseudo_info.orth_pin_mask = pseudo_info.diag_pin_mask = 0ull;
         }
-        while(pop_lsb_square(queens, sq)) {
-            all_attacked |= get_queen_moves(sq, 0ull, pieces_ignoring_king);
+        AttackInfo const& info = Legal ? legal_info : pseudo_info;
+        constexpr bool quiet = Type == GenType::QUIETS || Type == GenType::QUIET_CHECKS;
+        Square king_sq = state.king_sq[Us];
+        Bitboard own = state.color_bbs[Us], enemy = state.color_bbs[!Us];
+        Bitboard targets = (Type == GenType::CAPTURES) ? enemy : quiet ? ~state.all_pieces_bb : ~own;
+        Bitboard discoverers = 0ull;
+        if constexpr (Type == GenType::QUIET_CHECKS) {
+            discoverers = get_discovered_check_candidates<Us>(state);
         }
-        return all_attacked;
-    }
 
-    void MoveGenerator::compute_dest_masks(BoardState const &state, Color color, Bitboard checker, GenPolicy policy) {
-        Square king_sq = state.king_sq[color];
-        Bitboard own_pieces = state.color_bbs[color];
+        Bitboard king_dests = KING_ATTACKS[king_sq] & targets & ~info.enemy_attacks;
+        if constexpr (Type == GenType::QUIET_CHECKS) {
+            // the king can only give a discovered check.
+            king_dests &= (discoverers & bb_from_square(king_sq)) ? ~line_through(king_sq, state.king_sq[!Us]) : 0ull;
+        }
+        append_moves_from_dest_bb(moves, king_sq, king_dests);
 
-        Square checker_sq = A1;
-        Piece checker_piece = NO_PIECE;
+        if (std::popcount(info.checkers) >= 2) {
+            return; //. if in double check can only move the king.
+        }
 
-        // if we're in check, every piece can only capture the checker or move "in front" of it.
-        Bitboard default_mask = -1ull;
-        if(checker != 0ull) {
-            checker_sq = lsb_square_from_bb(checker);
-            checker_piece = state.pieces[checker_sq];
-            default_mask = bb_from_square(checker_sq);
-            if(is_slider(checker_piece)) {
-                default_mask |= segment_between(king_sq, checker_sq);
+        if constexpr (Type == GenType::ALL || Type == GenType::QUIETS) {
+            if (info.checkers == 0ull) {
+                // castling only possible if not in check
+                append_king_castle_moves<Us>(moves, state, info.enemy_attacks);
             }
         }
 
-        if(policy == GenPolicy::ONLY_CAPTURES) {
-            default_mask &= state.color_bbs[!color];
+        targets &= info.check_mask;
+        get_all_piece_moves<Us, KNIGHT, Type>(moves, state, info, targets, discoverers);
+        get_all_piece_moves<Us, BISHOP, Type>(moves, state, info, targets, discoverers);
+        get_all_piece_moves<Us, ROOK, Type>(moves, state, info, targets, discoverers);
+        get_all_piece_moves<Us, QUEEN, Type>(moves, state, info, targets, discoverers);
+        get_all_pawn_moves<Us, Type>(moves, state, info, discoverers);
+    }
+
+    template <Color Us, GenType Type>
+    void MoveGenerator::get_all_pawn_moves(MoveVector &moves, BoardState const &state, AttackInfo const& info, Bitboard discoverers) {
+        constexpr int push_offset = (Us == WHITE) ? 8 : -8;
+        constexpr Bitboard third_rank = RANK_BBS[(Us == WHITE) ? RANK_3 : RANK_6];
+        Bitboard pawns = state.piece_bb(PAWN, Us);
+
+        if constexpr (Type != GenType::CAPTURES) {
+            // a pawn pinned along a file can still push along it, a diagonally pinned one never can.
+            Bitboard pushers = pawns & ~info.diag_pin_mask;
+            Bitboard empty = ~state.all_pieces_bb;
+            Bitboard single = (pawn_push<Us>(pushers & ~info.orth_pin_mask) | (pawn_push<Us>(pushers & info.orth_pin_mask) & info.orth_pin_mask)) & empty;
+            Bitboard twice = pawn_push<Us>(single & third_rank) & empty;
+            if constexpr (Type == GenType::QUIET_CHECKS) {
+                // a push only leaves the line to the enemy king if the pawn isn't on the king's file.
+                Bitboard discovering = discoverers & pawns & ~FILE_BBS[file_of(state.king_sq[!Us])];
+                Bitboard checks = info.check_squares[PAWN] | pawn_push<Us>(discovering) | pawn_push<Us>(pawn_push<Us>(discovering));
+                single &= checks & ~back_rank_bb[Us];
+                twice &= checks;
+            }
+            append_pawn_moves_from_dest_bb<Us, push_offset>(moves, single & info.check_mask);
+            append_pawn_moves_from_dest_bb<Us, 2 * push_offset>(moves, twice & info.check_mask);
         }
 
-        std::fill(allowed_dest_mask.begin(), allowed_dest_mask.end(), default_mask);
+        if constexpr (Type != GenType::QUIETS && Type != GenType::QUIET_CHECKS) {
+            // a pawn pinned along a rank or file can never capture, a diagonally pinned one only along the pin.
+            Bitboard capturers = pawns & ~info.orth_pin_mask;
+            Bitboard free = capturers & ~info.diag_pin_mask, pinned = capturers & info.diag_pin_mask;
+            Bitboard targets = state.color_bbs[!Us] & info.check_mask;
+            Bitboard west = (pawn_west_captures<Us>(free) | (pawn_west_captures<Us>(pinned) & info.diag_pin_mask)) & targets;
+            Bitboard east = (pawn_east_captures<Us>(free) | (pawn_east_captures<Us>(pinned) & info.diag_pin_mask)) & targets;
+            append_pawn_moves_from_dest_bb<Us, push_offset - 1>(moves, west);
+            append_pawn_moves_from_dest_bb<Us, push_offset + 1>(moves, east);
 
-        // case where a pawn can enp capture the checker (inefficient but rare)
-        if(checker != 0ull && can_enp_capture(state, checker_sq, color)) {
-            Bitboard cap_pawns = PAWN_ATTACKS[!color][state.enp_square.value()] & state.piece_bbs[PAWN | color];
-            Square sq;
-            while (pop_lsb_square(cap_pawns, sq)) {
-                allowed_dest_mask[sq] |= bb_from_square(state.enp_square.value());
+            if(state.enp_square.has_value()) {
+                get_enp_moves<Us>(moves, state, info);
             }
         }
+    }
 
-        // op -> opponent
-        Bitboard opRQ = state.orth_slider_bb[!color];
-        Bitboard opBQ = state.diag_slider_bb[!color];
-        Bitboard potential_pin_squares = xray_queen_moves(state.all_pieces_bb, own_pieces, king_sq);
-
-        // pinned pieces.
-        for (Direction dir: all_directions) {
-            Bitboard dir_ray = RAY_BBS[dir][king_sq];
-            Bitboard ray_pin_squares = potential_pin_squares & dir_ray;
-            Bitboard op = is_orthogonal_dir(dir) ? opRQ : opBQ;
-            Bitboard pinner = ray_pin_squares & op;
-            if (pinner) {
-                Square pinner_sq = lsb_square_from_bb(pinner);
-                Bitboard pinned = dir_ray & RECTANGLE_BETWEEN[king_sq][pinner_sq] & own_pieces;
-                if (pinned) {
-                    Square pinned_sq = lsb_square_from_bb(pinned);
-                    allowed_dest_mask[pinned_sq] &= dir_ray;// should be &= in case of double pin.
-                }
+    template <Color Us>
+    void MoveGenerator::get_enp_moves(MoveVector &moves, BoardState const &state, AttackInfo const& info) {
+        Square enp = state.enp_square.value();
+        Bitboard candidates = PAWN_ATTACKS[!Us][enp] & state.piece_bb(PAWN, Us);
+        Square src;
+        while(pop_lsb_square(candidates, src)) {
+            if(enp_capture_allowed(state, Us, src, info.checkers)) {
+                moves.emplace_back(src, enp, EN_PASSANT);
             }
         }
     }
 
-    void MoveGenerator::get_all_piece_moves(MoveVector& moves, PieceType type, BoardState const &state, Color color) {
-        assert(type != KING && type != PAWN);
-        Bitboard src_bb = state.piece_bbs[type | color];
-        Bitboard own = state.color_bbs[color], enemy = state.color_bbs[!color];
-        while (src_bb) {
-            Square src = lsb_square_from_bb(src_bb);
-            Bitboard dests_bb = get_slider_and_knight_moves(type, src, own, enemy) & allowed_dest_mask[src];
-            append_moves_from_dest_bb(moves, src, dests_bb);
-            src_bb &= src_bb - 1;
+    bool enp_capture_allowed(BoardState const& state, Color us, Square src, Bitboard checkers) {
+        // rare enough to just check each one by removing both pawns and looking for attacks on the king,
+        // this also catches both pawns leaving the king's rank at once.
+        Square enp = state.enp_square.value();
+        Square captured = enp + ((us == WHITE) ? SOUTH : NORTH);
+        Square king_sq = state.king_sq[us];
+        // a knight or other pawn giving check can't be dealt with by this capture.
+        Bitboard other_checkers = checkers & ~bb_from_square(captured) & ~(state.orth_sliders(!us) | state.diag_sliders(!us));
+        if(other_checkers) {
+            return false;
+        }
+        Bitboard occupied = (state.all_pieces_bb ^ bb_from_square(src) ^ bb_from_square(captured)) | bb_from_square(enp);
+        return !(get_rook_moves(king_sq, 0ull, occupied) & state.orth_sliders(!us)) &&
+               !(get_bishop_moves(king_sq, 0ull, occupied) & state.diag_sliders(!us));
+    }
+
+    Bitboard get_all_attacked_squares(BoardState const &state, Color color) {
+        Bitboard all_attacked = 0ull;
+
+        all_attacked |= KING_ATTACKS[state.king_sq[color]];
+        Bitboard pawns = state.piece_bb(PAWN, color);
+        Bitboard knights = state.piece_bb(KNIGHT, color);
+        Square sq;
+
+        // xray through the opponents king for purpose of correctly determining squares that are in check
+        Bitboard pieces_ignoring_king = state.all_pieces_bb & ~bb_from_square(state.king_sq[!color]);
+        all_attacked |= (color == WHITE) ? all_pawn_attacks<WHITE>(pawns) : all_pawn_attacks<BLACK>(pawns);
+        while(pop_lsb_square(knights, sq)) {
+            all_attacked |= KNIGHT_ATTACKS[sq];
+        }
+        all_attacked |= get_slider_attacks_setwise(state.orth_sliders(color), state.diag_sliders(color), pieces_ignoring_king);
+        return all_attacked;
+    }
+
+    template <Color Us, PieceType Pt, GenType Type>
+    void MoveGenerator::get_all_piece_moves(MoveVector& moves, BoardState const &state, AttackInfo const& info, Bitboard targets, Bitboard discoverers) {
+        Bitboard src_bb = state.piece_bb(Pt, Us);
+        // a pinned knight can never move, a bishop pinned orthogonally or a rook pinned diagonally neither.
+        if constexpr (Pt == KNIGHT) {
+            src_bb &= ~(info.orth_pin_mask | info.diag_pin_mask);
+        } else if constexpr (Pt == BISHOP) {
+            src_bb &= ~info.orth_pin_mask;
+        } else if constexpr (Pt == ROOK) {
+            src_bb &= ~info.diag_pin_mask;
+        }
+        Bitboard own = state.color_bbs[Us], enemy = state.color_bbs[!Us];
+        Square src;
+        while(pop_lsb_square(src_bb, src)) {
+            Bitboard dests_bb;
+            if(info.orth_pin_mask & bb_from_square(src)) {
+                dests_bb = get_rook_moves(src, own, enemy) & info.orth_pin_mask;
+            } else if(info.diag_pin_mask & bb_from_square(src)) {
+                dests_bb = get_bishop_moves(src, own, enemy) & info.diag_pin_mask;
+            } else {
+                dests_bb = get_slider_and_knight_moves<Pt>(src, own, enemy);
+            }
+            if constexpr (Type == GenType::QUIET_CHECKS) {
+                Bitboard checks = info.check_squares[Pt];
+                if (discoverers & bb_from_square(src)) {
+                    checks |= ~line_through(src, state.king_sq[!Us]);
+                }
+                dests_bb &= checks;
+            }
+            append_moves_from_dest_bb(moves, src, dests_bb & targets);
         }
     }
-}
+}
\ No newline at end of file
@@ -18,23 +18,56 @@ namespace jchess {
 #endif
 
     Bitboard get_all_attacked_squares(BoardState const& state, Color color);
+    // whether our pawn on src can take en passant, with no other checker left standing and no slider seeing our king
+    // once both pawns are gone. pins can't tell when both leave the king's rank, so legal and pseudo-legal moves share it.
+    bool enp_capture_allowed(BoardState const& state, Color us, Square src, Bitboard checkers);
 
-    enum class GenPolicy {
-        LEGAL,
-        ONLY_CAPTURES
+    // every type gives legal moves from get_legal_moves, or pseudo-legal ones from get_pseudo_legal_moves.
+    enum class GenType {
+        ALL,
+        CAPTURES, // including en passant and promotions that capture.
+        QUIETS, // everything that isn't a capture, castling and quiet promotions included.
+        EVASIONS, // only for when in check, ALL without looking at castling.
+        QUIET_CHECKS // quiet moves giving a direct or discovered check, not counting promotions or castling.
     };
 
+    // the attacks in a position from the point of view of the side to move. movegen, check detection
+    // and move ordering all need parts of it, Board caches it per position.
+    struct AttackInfo {
+        Bitboard enemy_attacks = 0; // xrays through our king, so it can't step back along the line of a check. not set by compute_check_info.
+        Bitboard checkers = 0;
+        Bitboard check_mask = 0; // where a non king move has to go, the checker or in front of it, everywhere if not in check.
+        Bitboard orth_pin_mask = 0; // the rays from our king to each pinning rook/queen, including the pinner.
+        Bitboard diag_pin_mask = 0; // the same for pinning bishops/queens.
+        Bitboard pinned = 0;
+        std::array<Bitboard, 6> check_squares = {}; // by PieceType, where our piece of that type would give check from.
+    };
+
+    AttackInfo compute_attack_info(BoardState const& state, Color color);
+    // everything but enemy_attacks, which is the expensive part and only needed to generate legal king moves.
+    AttackInfo compute_check_info(BoardState const& state, Color color);
+
+    // legal moves from a check mask and pin rays computed once per position, every piece's
+    // destinations are then masked set-wise instead of checking each move. the colour and type are
+    // dispatched on once, so directions, ranks and which kinds of move to make are compile time constants.
     class MoveGenerator {
     public:
         MoveGenerator() = default;
-        void get_legal_moves(MoveVector& moves, BoardState const& state, Color color, GenPolicy policy = GenPolicy::LEGAL);
-    private:
-        void get_all_pawn_moves(MoveVector& moves, BoardState const& state, Color color); // pin aware
-        Bitboard get_pawn_moves(Square square, BoardState const& state, Color color); // pin aware
-        void get_king_non_castle_moves(MoveVector& moves, BoardState const& state, Color color);
-        void compute_dest_masks(BoardState const& state, Color color, Bitboard checker, GenPolicy policy);
-        void get_all_piece_moves(MoveVector& moves, PieceType type, BoardState const &state, Color color); // pin aware
+        void get_legal_moves(MoveVector& moves, BoardState const& state, Color color, GenType type = GenType::ALL);
+        void get_legal_moves(MoveVector& moves, BoardState const& state, Color color, AttackInfo const& info, GenType type = GenType::ALL);
+        // the same moves without pins, king safety or castling through check being looked at, so some may leave
+        // the king in check. only needs the info from compute_check_info, check and double check are still respected.
+        void get_pseudo_legal_moves(MoveVector& moves, BoardState const& state, Color color, AttackInfo const& info, GenType type = GenType::ALL);
     private:
-        std::array<Bitboard, 64> allowed_dest_mask; // there should be a more efficient way to store this
+        template <Color Us, bool Legal>
+        void dispatch(MoveVector& moves, BoardState const& state, AttackInfo const& info, GenType type);
+        template <Color Us, GenType Type, bool Legal>
+        void generate(MoveVector& moves, BoardState const& state, AttackInfo const& info);
+        template <Color Us, GenType Type>
+        void get_all_pawn_moves(MoveVector& moves, BoardState const& state, AttackInfo const& info, Bitboard discoverers);
+        template <Color Us>
+        void get_enp_moves(MoveVector& moves, BoardState const& state, AttackInfo const& info);
+        template <Color Us, PieceType Pt, GenType Type>
+        void get_all_piece_moves(MoveVector& moves, BoardState const& state, AttackInfo const& info, Bitboard targets, Bitboard discoverers);
     };
 }
\ No newline at end of file
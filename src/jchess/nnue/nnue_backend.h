@@ -0,0 +1,65 @@
+#pragma once
+
+#include "../board.h"
+#include "wrap_nnue.h"
+
+#include <memory>
+#include <span>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define JCHESS_NNUE_X86
+#elif defined(__aarch64__)
+#define JCHESS_NNUE_NEON
+#endif
+
+namespace jchess::nnue_eval {
+    // the evaluator compiled for one instruction set, see nnue_backend_impl.h
+    class NNUEBackend {
+    public:
+        virtual ~NNUEBackend() = default;
+        virtual int32_t nnue_eval_board(Board const& board) = 0;
+        virtual int32_t nnue_eval_full(Board const& board) const = 0;
+        virtual uint64_t refresh_table_hits() const = 0;
+        virtual void write_image(std::string const& image_file) const = 0;
+        virtual bool is_mapped() const = 0;
+        virtual std::string architecture() const = 0;
+        // evals[i] is the evaluation of positions[i], must be safe to call from several threads at once
+        virtual void eval_batch(std::span<PackedPosition const> positions, std::span<int32_t> evals, int num_threads) const = 0;
+    };
+
+    namespace generic {
+        std::unique_ptr<NNUEBackend> make_backend(std::string const& network_file);
+        HiddenLayerProducts hidden_layer_products(std::span<uint8_t const> input, std::span<int8_t const> weights,
+                                                  std::span<int32_t const> biases);
+    }
+#ifdef JCHESS_NNUE_X86
+    namespace sse2 {
+        std::unique_ptr<NNUEBackend> make_backend(std::string const& network_file);
+        HiddenLayerProducts hidden_layer_products(std::span<uint8_t const> input, std::span<int8_t const> weights,
+                                                  std::span<int32_t const> biases);
+    }
+    namespace ssse3 {
+        std::unique_ptr<NNUEBackend> make_backend(std::string const& network_file);
+        HiddenLayerProducts hidden_layer_products(std::span<uint8_t const> input, std::span<int8_t const> weights,
+                                                  std::span<int32_t const> biases);
+    }
+    namespace avx2 {
+        std::unique_ptr<NNUEBackend> make_backend(std::string const& network_file);
+        HiddenLayerProducts hidden_layer_products(std::span<uint8_t const> input, std::span<int8_t const> weights,
+                                                  std::span<int32_t const> biases);
+    }
+    namespace avx512 {
+        std::unique_ptr<NNUEBackend> make_backend(std::string const& network_file);
+        HiddenLayerProducts hidden_layer_products(std::span<uint8_t const> input, std::span<int8_t const> weights,
+                                                  std::span<int32_t const> biases);
+    }
+#endif
+#ifdef JCHESS_NNUE_NEON
+    namespace neon {
+        std::unique_ptr<NNUEBackend> make_backend(std::string const& network_file);
+        HiddenLayerProducts hidden_layer_products(std::span<uint8_t const> input, std::span<int8_t const> weights,
+                                                  std::span<int32_t const> biases);
+    }
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,9 @@
+#include "nnue_backend.h"
+
+#ifdef JCHESS_NNUE_X86
+#define NNUE_BACKEND avx2
+#define NNUE_TARGET "avx2"
+#define SIMD
+#define AVX2
+#include "nnue_backend_impl.h"
+#endif
\ No newline at end of file
@@ -0,0 +1,11 @@
+#include "nnue_backend.h"
+
+#ifdef JCHESS_NNUE_X86
+// the jdart avx512 kernels fall back to the avx2 ones for layers narrower than 512 bits.
+#define NNUE_BACKEND avx512
+#define NNUE_TARGET "avx512f,avx512bw,avx2"
+#define SIMD
+#define AVX2
+#define AVX512
+#include "nnue_backend_impl.h"
+#endif
\ No newline at end of file
@@ -0,0 +1,3 @@
+// plain C++ loops, used when the host supports none of the SIMD backends.
+#define NNUE_BACKEND generic
+#include "nnue_backend_impl.h"
\ No newline at end of file
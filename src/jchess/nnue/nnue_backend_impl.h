@@ -0,0 +1,471 @@
+#pragma once
+
+// the nnue evaluator, included by each of the nnue_backend_*.cpp files to compile it for one instruction set.
+// The including file defines NNUE_BACKEND, the namespace for its make_backend, and for a SIMD build
+// defines SIMD, the jdart instruction set macros and NNUE_TARGET, which is applied to the jdart code only.
+// Everything else is compiled for the baseline target, so it is safe to link with the other backends.
+
+#include "../board.h"
+#include "nnue_backend.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <mio/mmap.hpp>
+
+#if defined(SIMD) && defined(NEON)
+#include <arm_neon.h>
+#elif defined(SIMD)
+#include <immintrin.h>
+#endif
+
+#define NNUE_CONCAT_IMPL(a, b) a##b
+#define NNUE_CONCAT(a, b) NNUE_CONCAT_IMPL(a, b)
+#define NNUE_PRAGMA_IMPL(x) _Pragma(#x)
+#define NNUE_PRAGMA(x) NNUE_PRAGMA_IMPL(x)
+
+#ifdef NNUE_TARGET
+#if defined(__clang__)
+NNUE_PRAGMA(clang attribute push(__attribute__((target(NNUE_TARGET))), apply_to = function))
+#else
+NNUE_PRAGMA(GCC push_options)
+NNUE_PRAGMA(GCC target(NNUE_TARGET))
+#endif
+#endif
+
+// the jdart code is all inline, so each backend gets its own copy in its own namespace.
+namespace NNUE_CONCAT(jdart_, NNUE_BACKEND) {
+#include "nnue.h"
+}
+
+#ifdef NNUE_TARGET
+#if defined(__clang__)
+NNUE_PRAGMA(clang attribute pop)
+#else
+NNUE_PRAGMA(GCC pop_options)
+#endif
+#endif
+
+namespace nnue = NNUE_CONCAT(jdart_, NNUE_BACKEND)::nnue;
+
+namespace {
+    nnue::Piece convert_piece(jchess::Piece piece) {
+        // my ordering PAWN, ROOK, KNIGHT, BISHOP, KING, QUEEN
+        // white offset 0, black offset 9, [pawn, knight, bishop, rook, queen, king]
+        auto type = jchess::type_from_piece(piece);
+        auto color = jchess::color_from_piece(piece);
+        int color_offset = (color == jchess::WHITE) ? 0 : 8;
+        int type_offsets[6] = {1, 4, 2, 3, 6, 5};
+        return static_cast<nnue::Piece>(color_offset + type_offsets[type]);
+    }
+
+    nnue::Square convert_square(jchess::Square square) {
+        return (square == jchess::NUM_SQUARES) ? nnue::InvalidSquare : static_cast<nnue::Square>(square);
+    }
+
+    nnue::Color convert_color(jchess::Color color) {
+        return (color == jchess::WHITE) ? nnue::White : nnue::Black;
+    }
+
+    // the accumulator for the position at a ply, valid while the board still has the same position id there.
+    template <typename Network>
+    struct AccumulatorEntry {
+        typename Network::AccumulatorType accum;
+        uint64_t position_id = 0;
+    };
+
+    template <typename Network>
+    using AccumulatorStack = std::vector<AccumulatorEntry<Network>>;
+
+    // the last accumulator half computed with the king on a square, kept in the lower half,
+    // and the pieces it was computed for. A refresh then only needs the difference in pieces.
+    template <typename Network>
+    struct RefreshEntry {
+        typename Network::AccumulatorType accum;
+        std::array<jchess::Bitboard, 6> type_bbs = {};
+        std::array<jchess::Bitboard, 2> color_bbs = {};
+        jchess::Bitboard piece_bb(jchess::Piece piece) const {
+            return type_bbs[jchess::type_from_piece(piece)] & color_bbs[jchess::color_from_piece(piece)];
+        }
+        bool valid = false;
+    };
+
+    // indexed by [king square][perspective]
+    template <typename Network>
+    using RefreshTable = std::array<std::array<RefreshEntry<Network>, 2>, 64>;
+
+    // see third_party/nnue/interface for the expected/possible methods of this class, this one
+    // views the position at some ply of the board's move history along with its accumulator.
+    template <typename Network>
+    class NNUEChessInterface {
+    public:
+        NNUEChessInterface(AccumulatorStack<Network>& stack, jchess::Board const& board, int ply)
+            : stack{&stack}, board{&board}, ply{ply} {}
+
+        nnue::Color sideToMove() const noexcept {
+            jchess::Color color = board->get_side_to_move();
+            return convert_color(((board->get_ply() - ply) % 2 == 0) ? color : !color);
+        }
+
+        // only the current king squares are known, only used for a side whose king hasn't moved since ply.
+        nnue::Square kingSquare(nnue::Color side) const noexcept {
+            jchess::Color color = (side == nnue::White) ? jchess::WHITE : jchess::BLACK;
+            return static_cast<nnue::Square>(board->get_board_state().king_sq[color]);
+        }
+
+        unsigned pieceCount() const noexcept {
+            return board->get_num_pieces();
+        }
+
+        typename Network::AccumulatorType& getAccumulator() const noexcept {
+            return (*stack)[ply].accum;
+        }
+
+        unsigned getDirtyNum() const {
+            return board->get_dirty_pieces(ply).num;
+        }
+
+        void getDirtyState(size_t index, nnue::Square& from, nnue::Square& to, nnue::Piece& piece) const {
+            jchess::DirtyPiece const& dirty = board->get_dirty_pieces(ply).pieces[index];
+            from = convert_square(dirty.from);
+            to = convert_square(dirty.to);
+            piece = convert_piece(dirty.piece);
+        }
+
+        bool previous() {
+            if(ply == 0) {
+                return false;
+            }
+            --ply;
+            return true;
+        }
+
+        friend bool operator==(NNUEChessInterface const& lhs, NNUEChessInterface const& rhs) {
+            return lhs.ply == rhs.ply;
+        }
+
+    private:
+        AccumulatorStack<Network>* stack;
+        jchess::Board const* board;
+        int ply;
+    };
+}
+
+
+namespace jchess::nnue_eval {
+    namespace {
+        // keeps an accumulator per ply of the board's move history, each one is brought up to date lazily
+        // from the nearest computed ancestor using the pieces changed by each move in between. When the
+        // king has moved the refresh table is used instead. Not thread safe, use one evaluator per thread.
+        template <typename Network>
+        class Backend final : public NNUEBackend {
+        public:
+            using Evaluator = nnue::Evaluator<NNUEChessInterface<Network>, Network>;
+            using AccumulatorType = typename Network::AccumulatorType;
+
+            // either a network file, which is parsed, or an image written by write_image, which is used in
+            // place, so processes using the same image share its pages. mapped_file is network_file, mapped.
+            Backend(mio::mmap_source&& mapped_file, std::string const& network_file) : image{std::move(mapped_file)} {
+                auto const* data = reinterpret_cast<std::byte const*>(image.data());
+                if(Network::isImage(data, image.size())) {
+                    if(!network.mapImage(data, image.size())) {
+                        throw std::runtime_error("nnue: network image does not match this network");
+                    }
+                    return;
+                }
+                image.unmap();
+                std::ifstream file {network_file, std::ios::binary};
+                file >> network;
+                if(file.bad()) {
+                    throw std::runtime_error("nnue: could not read network file");
+                }
+            }
+            void write_image(std::string const& image_file) const override {
+                std::ofstream file {image_file, std::ios::binary};
+                network.writeImage(file);
+                if(!file) {
+                    throw std::runtime_error("nnue: could not write network image");
+                }
+            }
+            bool is_mapped() const override {
+                return image.is_mapped();
+            }
+            std::string architecture() const override {
+                return "halfkp_" + std::to_string(Network::FeatureXformerOutputSize) + "x2-"
+                    + std::to_string(Network::Hidden1Size) + "-" + std::to_string(Network::Hidden2Size);
+            }
+            int32_t nnue_eval_board(jchess::Board const& board) override {
+                int ply = board.get_ply();
+                if(accumulators.size() <= static_cast<size_t>(ply)) {
+                    accumulators.resize(ply + 1);
+                }
+                AccumulatorEntry<Network>& entry = accumulators[ply];
+                if(entry.position_id != board.get_position_id(ply)) {
+                    entry.position_id = board.get_position_id(ply);
+                    entry.accum.setEmpty();
+                }
+                NNUEChessInterface<Network> intf{accumulators, board, ply};
+                for(jchess::Color color : {jchess::WHITE, jchess::BLACK}) {
+                    update_accumulator(intf, board, ply, color);
+                }
+                return network.evaluate(entry.accum);
+            }
+            int32_t nnue_eval_full(jchess::Board const& board) const override {
+                AccumulatorType accum;
+                nnue::Color side_to_move = convert_color(board.get_side_to_move());
+                for(jchess::Color color : {jchess::WHITE, jchess::BLACK}) {
+                    full_refresh(board.get_board_state(), color, side_to_move, accum);
+                }
+                return network.evaluate(accum);
+            }
+            uint64_t refresh_table_hits() const override {
+                return table_hits;
+            }
+            // positions with the same king squares are evaluated one after another, each thread with its own
+            // refresh table, so a refresh only loads the feature columns of the pieces that differ from the
+            // previous position with that king square.
+            void eval_batch(std::span<PackedPosition const> positions, std::span<int32_t> evals, int num_threads) const override {
+                std::vector<uint32_t> order(positions.size());
+                std::iota(order.begin(), order.end(), 0);
+                auto king_key = [&positions](uint32_t index) {
+                    jchess::BoardState const& state = positions[index].state;
+                    return state.king_sq[jchess::WHITE] * 64 + state.king_sq[jchess::BLACK];
+                };
+                std::stable_sort(order.begin(), order.end(), [&king_key](uint32_t lhs, uint32_t rhs) {
+                    return king_key(lhs) < king_key(rhs);
+                });
+                auto eval_range = [&](size_t begin, size_t end) {
+                    auto table = std::make_unique<RefreshTable<Network>>();
+                    AccumulatorType accum;
+                    for(size_t i = begin; i < end; ++i) {
+                        PackedPosition const& position = positions[order[i]];
+                        nnue::Color side_to_move = convert_color(position.side_to_move);
+                        for(jchess::Color color : {jchess::WHITE, jchess::BLACK}) {
+                            refresh_from_table(*table, position.state, color, side_to_move, accum);
+                        }
+                        evals[order[i]] = network.evaluate(accum);
+                    }
+                };
+                size_t per_thread = (order.size() + num_threads - 1) / num_threads;
+                std::vector<std::thread> threads;
+                for(int thread = 1; thread < num_threads; ++thread) {
+                    size_t begin = std::min(order.size(), thread * per_thread);
+                    threads.emplace_back(eval_range, begin, std::min(order.size(), begin + per_thread));
+                }
+                eval_range(0, std::min(order.size(), per_thread));
+                for(std::thread& thread : threads) {
+                    thread.join();
+                }
+            }
+        private:
+            void update_accumulator(NNUEChessInterface<Network>& intf, jchess::Board const& board, int ply, jchess::Color color) {
+                nnue::Color side = convert_color(color);
+                auto half = AccumulatorType::getHalf(side, intf.sideToMove());
+                if(intf.getAccumulator().getState(half) == nnue::AccumulatorState::Computed) {
+                    return;
+                }
+                std::optional<int> source = find_computed_ancestor(board, ply, color);
+                if(source) {
+                    NNUEChessInterface<Network> source_intf{accumulators, board, source.value()};
+                    Evaluator::updateAccumIncremental(network, source_intf, intf, side);
+                } else {
+                    refresh_accumulator(intf, board, color);
+                }
+            }
+
+            // the closest earlier ply with a valid accumulator half for color, if the king of that color
+            // hasn't moved since and an incremental update would touch fewer features than a refresh.
+            std::optional<int> find_computed_ancestor(jchess::Board const& board, int ply, jchess::Color color) {
+                int budget = board.get_num_pieces() - 2; // the non king pieces
+                for(int prev = ply; prev > 0; --prev) {
+                    jchess::DirtyPieces const& dirty = board.get_dirty_pieces(prev);
+                    for(int i = 0; i < dirty.num; ++i) {
+                        if(dirty.pieces[i].piece == (jchess::KING | color)) {
+                            return std::nullopt; // king moved, every feature for this side changes
+                        }
+                    }
+                    budget -= dirty.num + 1;
+                    if(budget < 0) {
+                        return std::nullopt;
+                    }
+                    AccumulatorEntry<Network> const& entry = accumulators[prev - 1];
+                    if(entry.position_id != board.get_position_id(prev - 1)) {
+                        continue;
+                    }
+                    NNUEChessInterface<Network> prev_intf{accumulators, board, prev - 1};
+                    auto half = AccumulatorType::getHalf(convert_color(color), prev_intf.sideToMove());
+                    if(entry.accum.getState(half) == nnue::AccumulatorState::Computed) {
+                        return prev - 1;
+                    }
+                }
+                return std::nullopt;
+            }
+
+            void refresh_accumulator(NNUEChessInterface<Network>& intf, jchess::Board const& board, jchess::Color color) {
+                table_hits += (*refresh_table)[board.get_board_state().king_sq[color]][color].valid;
+                refresh_from_table(*refresh_table, board.get_board_state(), color, intf.sideToMove(), intf.getAccumulator());
+            }
+
+            // computes color's half of accum from the table entry for its king square, applying the difference
+            // in pieces since the entry was last used.
+            void refresh_from_table(RefreshTable<Network>& table, jchess::BoardState const& state, jchess::Color color,
+                                    nnue::Color side_to_move, AccumulatorType& accum) const {
+                nnue::Color side = convert_color(color);
+                auto half = AccumulatorType::getHalf(side, side_to_move);
+                RefreshEntry<Network>& entry = table[state.king_sq[color]][color];
+                if(!entry.valid) {
+                    full_refresh(state, color, side_to_move, accum);
+                    entry.accum.copy_half(nnue::AccumulatorHalf::Lower, accum, half);
+                    entry.type_bbs = state.type_bbs;
+                    entry.color_bbs = state.color_bbs;
+                    entry.valid = true;
+                    return;
+                }
+                auto const* xformer = network.getFeatureXformer();
+                for(int piece = 0; piece < 12; ++piece) {
+                    if(jchess::type_from_piece(static_cast<jchess::Piece>(piece)) == jchess::KING) {
+                        continue;
+                    }
+                    auto as_piece = static_cast<jchess::Piece>(piece);
+                    jchess::Bitboard removed = entry.piece_bb(as_piece) & ~state.piece_bb(as_piece);
+                    jchess::Bitboard added = state.piece_bb(as_piece) & ~entry.piece_bb(as_piece);
+                    jchess::Square square;
+                    while(jchess::pop_lsb_square(removed, square)) {
+                        unsigned index = feature_index(state, color, static_cast<jchess::Piece>(piece), square);
+                        entry.accum.sub_half(nnue::AccumulatorHalf::Lower, xformer->getCol(index));
+                    }
+                    while(jchess::pop_lsb_square(added, square)) {
+                        unsigned index = feature_index(state, color, static_cast<jchess::Piece>(piece), square);
+                        entry.accum.add_half(nnue::AccumulatorHalf::Lower, xformer->getCol(index));
+                    }
+                }
+                entry.type_bbs = state.type_bbs;
+                entry.color_bbs = state.color_bbs;
+                accum.copy_half(half, entry.accum, nnue::AccumulatorHalf::Lower);
+                accum.setState(half, nnue::AccumulatorState::Computed);
+            }
+
+            void full_refresh(jchess::BoardState const& state, jchess::Color color, nnue::Color side_to_move,
+                              AccumulatorType& accum) const {
+                nnue::IndexArray indices;
+                auto it = indices.begin();
+                jchess::Bitboard pieces = state.all_pieces_bb & ~state.type_bbs[jchess::KING];
+                jchess::Square square;
+                while(jchess::pop_lsb_square(pieces, square)) {
+                    *it++ = feature_index(state, color, state.pieces[square], square);
+                }
+                *it = nnue::LAST_INDEX;
+                Evaluator::updateAccum(network, indices, convert_color(color), side_to_move, accum);
+            }
+
+            static unsigned feature_index(jchess::BoardState const& state, jchess::Color color, jchess::Piece piece, jchess::Square square) {
+                nnue::Square king_sq = static_cast<nnue::Square>(state.king_sq[color]);
+                if(color == jchess::WHITE) {
+                    return Network::template getIndex<nnue::White>(king_sq, convert_piece(piece), square);
+                }
+                return Network::template getIndex<nnue::Black>(king_sq, convert_piece(piece), square);
+            }
+
+            mio::mmap_source image;
+            Network network;
+            AccumulatorStack<Network> accumulators;
+            // ~130KB, so kept off the stack.
+            std::unique_ptr<RefreshTable<Network>> refresh_table = std::make_unique<RefreshTable<Network>>();
+            uint64_t table_hits = 0;
+        };
+
+        using DefaultNetwork = nnue::BasicNetwork<nnue::HalfKp256Architecture>;
+        using SmallNetwork = nnue::BasicNetwork<nnue::HalfKp128Architecture>;
+
+        struct NetworkFileHeader {
+            bool is_image = false;
+            uint32_t architecture = 0;
+            size_t parameters_size = 0; // only for a network file
+        };
+
+        NetworkFileHeader read_network_header(mio::mmap_source const& file) {
+            NetworkFileHeader header;
+            auto const* data = reinterpret_cast<std::byte const*>(file.data());
+            if(DefaultNetwork::isImage(data, file.size())) {
+                header.is_image = true;
+                header.architecture = DefaultNetwork::imageArchitecture(data, file.size());
+            } else if(file.size() >= 3 * sizeof(uint32_t)) {
+                // version, architecture hash, length of the architecture string
+                uint32_t description_size = 0;
+                std::memcpy(&header.architecture, data + sizeof(uint32_t), sizeof(uint32_t));
+                std::memcpy(&description_size, data + 2 * sizeof(uint32_t), sizeof(uint32_t));
+                size_t header_size = 3 * sizeof(uint32_t) + description_size;
+                header.parameters_size = (file.size() > header_size) ? file.size() - header_size : 0;
+            }
+            return header;
+        }
+
+        // files that don't have Stockfish's architecture hash in their header are recognised by their size.
+        template <typename Network>
+        bool has_architecture(NetworkFileHeader const& header) {
+            return header.architecture == Network::architectureHash()
+                || (!header.is_image && header.parameters_size == Network::fileParametersSize());
+        }
+    }
+
+    namespace NNUE_BACKEND {
+        std::unique_ptr<NNUEBackend> make_backend(std::string const& network_file) {
+            mio::mmap_source file;
+            std::error_code err_code;
+            file.map(network_file, 0, mio::map_entire_file, err_code);
+            if(err_code) {
+                throw std::runtime_error("nnue: could not read network file");
+            }
+            NetworkFileHeader header = read_network_header(file);
+            if(has_architecture<DefaultNetwork>(header)) {
+                return std::make_unique<Backend<DefaultNetwork>>(std::move(file), network_file);
+            }
+            if(has_architecture<SmallNetwork>(header)) {
+                return std::make_unique<Backend<SmallNetwork>>(std::move(file), network_file);
+            }
+            throw std::runtime_error("nnue: unknown network architecture");
+        }
+
+        HiddenLayerProducts hidden_layer_products(std::span<uint8_t const> input, std::span<int8_t const> weights,
+                                                  std::span<int32_t const> biases) {
+            using Layer = DefaultNetwork::Layer2;
+            static_assert(Layer::sparseInput);
+            static_assert(DefaultNetwork::FeatureXformerOutputSize * 2 == HIDDEN_LAYER_INPUTS);
+            static_assert(DefaultNetwork::Hidden1Size == HIDDEN_LAYER_OUTPUTS);
+            // read is the only way to set the biases, and also lays out the weights for the sparse kernel.
+            std::stringstream parameters;
+            for(int32_t bias : biases) {
+                for(int byte = 0; byte < 4; ++byte) {
+                    parameters.put(static_cast<char>(static_cast<uint32_t>(bias) >> (8 * byte)));
+                }
+            }
+            parameters.write(reinterpret_cast<char const*>(weights.data()), static_cast<std::streamsize>(weights.size()));
+            auto layer = std::make_unique<Layer>();
+            layer->read(parameters);
+            // the kernels load whole vectors, so they get the alignment they have in the network.
+            alignas(64) uint8_t aligned_input[HIDDEN_LAYER_INPUTS];
+            alignas(64) int32_t output[HIDDEN_LAYER_OUTPUTS];
+            std::copy(input.begin(), input.end(), aligned_input);
+            HiddenLayerProducts products;
+            layer->sparseDotProduct(aligned_input, output);
+            products.sparse.assign(output, output + HIDDEN_LAYER_OUTPUTS);
+            layer->dotProduct(aligned_input, output);
+            products.dense.assign(output, output + HIDDEN_LAYER_OUTPUTS);
+            return products;
+        }
+    }
+}
\ No newline at end of file
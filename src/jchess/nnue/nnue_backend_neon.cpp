@@ -0,0 +1,8 @@
+#include "nnue_backend.h"
+
+#ifdef JCHESS_NNUE_NEON
+#define NNUE_BACKEND neon
+#define SIMD
+#define NEON
+#include "nnue_backend_impl.h"
+#endif
\ No newline at end of file
@@ -0,0 +1,10 @@
+#include "nnue_backend.h"
+
+#ifdef JCHESS_NNUE_X86
+#define NNUE_BACKEND ssse3
+#define NNUE_TARGET "ssse3"
+#define SIMD
+#define SSE2
+#define SSSE3
+#include "nnue_backend_impl.h"
+#endif
\ No newline at end of file
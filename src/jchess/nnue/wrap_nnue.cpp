@@ -1,88 +1,175 @@
-#include "nnue.h"
 #include "wrap_nnue.h"
-#include <fstream>
-
-namespace {
-    nnue::Piece convert_piece(jchess::Piece piece) {
-        // my ordering PAWN, ROOK, KNIGHT, BISHOP, KING, QUEEN
-        // white offset 0, black offset 9, [pawn, knight, bishop, rook, queen, king]
-        auto type = jchess::type_from_piece(piece);
-        auto color = jchess::color_from_piece(piece);
-        int color_offset = (color == jchess::WHITE) ? 0 : 8;
-        int type_offsets[6] = {1, 4, 2, 3, 6, 5};
-        return static_cast<nnue::Piece>(color_offset + type_offsets[type]);
-    }
+#include "nnue_backend.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
-    // see third_party/nnue/interface for the expected/possible methods of this class
-    class NNUEChessInterface {
-    public:
-        NNUEChessInterface(jchess::Board const& board) : board{board} {
-            auto state = board.get_board_state();
-            for(int sq=0; sq<64; ++sq) {
-                if(state.pieces[sq] != jchess::NO_PIECE) {
-                    locs[sq] = convert_piece(state.pieces[sq]);
-                }
+namespace jchess::nnue_eval {
+    namespace {
+        constexpr SimdLevel all_simd_levels[] = {
+            SimdLevel::AVX512, SimdLevel::AVX2, SimdLevel::SSSE3, SimdLevel::SSE2, SimdLevel::NEON, SimdLevel::GENERIC
+        };
+
+        bool cpu_supports(SimdLevel level) {
+#ifdef JCHESS_NNUE_X86
+            __builtin_cpu_init();
+            switch(level) {
+                case SimdLevel::SSE2:
+                    return __builtin_cpu_supports("sse2");
+                case SimdLevel::SSSE3:
+                    return __builtin_cpu_supports("ssse3");
+                case SimdLevel::AVX2:
+                    return __builtin_cpu_supports("avx2");
+                case SimdLevel::AVX512:
+                    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+                default:
+                    break;
             }
-        }
-        nnue::Color sideToMove() const noexcept {
-            return board.get_side_to_move() == jchess::WHITE ? nnue::White : nnue::Black;
+#elif defined(JCHESS_NNUE_NEON)
+            if(level == SimdLevel::NEON) {
+                return true;
+            }
+#endif
+            return level == SimdLevel::GENERIC;
         }
 
-        nnue::Square kingSquare(nnue::Color side) const noexcept {
-            jchess::Color color = (side == nnue::White) ? jchess::WHITE : jchess::BLACK;
-            return static_cast<nnue::Square>(board.get_board_state().king_sq[color]);
+        std::unique_ptr<NNUEBackend> make_backend(SimdLevel level, std::string const& network_file) {
+            switch(level) {
+#ifdef JCHESS_NNUE_X86
+                case SimdLevel::SSE2:
+                    return sse2::make_backend(network_file);
+                case SimdLevel::SSSE3:
+                    return ssse3::make_backend(network_file);
+                case SimdLevel::AVX2:
+                    return avx2::make_backend(network_file);
+                case SimdLevel::AVX512:
+                    return avx512::make_backend(network_file);
+#endif
+#ifdef JCHESS_NNUE_NEON
+                case SimdLevel::NEON:
+                    return neon::make_backend(network_file);
+#endif
+                default:
+                    return generic::make_backend(network_file);
+            }
         }
+    }
 
-        unsigned pieceCount() const noexcept {
-            return board.get_num_pieces();
+    std::string_view simd_level_name(SimdLevel level) {
+        switch(level) {
+            case SimdLevel::SSE2:
+                return "sse2";
+            case SimdLevel::SSSE3:
+                return "ssse3";
+            case SimdLevel::AVX2:
+                return "avx2";
+            case SimdLevel::AVX512:
+                return "avx512";
+            case SimdLevel::NEON:
+                return "neon";
+            default:
+                return "generic";
         }
+    }
 
-        auto begin() const noexcept { return locs.begin(); }
-
-        auto end() const noexcept { return locs.end(); }
-
-    private:
-        jchess::Board const& board;
-        std::unordered_map<nnue::Square, nnue::Piece> locs;
-    };
-}
+    bool simd_level_available(SimdLevel level) {
+        return cpu_supports(level);
+    }
 
+    SimdLevel best_simd_level() {
+        // checked once, the cpu isn't going to change under us
+        static const SimdLevel best = *std::find_if(std::begin(all_simd_levels), std::end(all_simd_levels), simd_level_available);
+        return best;
+    }
 
-namespace jchess::nnue_eval {
-    // TODO: the eval methods here don't use the api in the most efficient way, revisit this
-    class NNUEEvaluator::impl {
-    public:
-        impl(std::string const& network_file) {
-            std::ifstream file {network_file};
-            file >> network;
-            if(file.bad()) {
-                throw std::runtime_error("nnue: could not read network file");
-            }
+    HiddenLayerProducts hidden_layer_products(SimdLevel level, std::span<uint8_t const> input,
+                                              std::span<int8_t const> weights, std::span<int32_t const> biases) {
+        if(!simd_level_available(level)) {
+            throw std::runtime_error(std::string("nnue: instruction set not available: ") + std::string(simd_level_name(level)));
         }
-        int32_t nnue_eval_fen(std::string const& fen) {
-            NNUEChessInterface intf{jchess::Board{fen}};
-            return nnue::Evaluator<NNUEChessInterface>::fullEvaluate(network, intf);
+        if(input.size() != HIDDEN_LAYER_INPUTS || weights.size() != HIDDEN_LAYER_INPUTS * HIDDEN_LAYER_OUTPUTS ||
+           biases.size() != HIDDEN_LAYER_OUTPUTS) {
+            throw std::invalid_argument("nnue: wrong size for the hidden layer");
         }
-        int32_t nnue_eval_board(jchess::Board const& board) {
-            NNUEChessInterface intf{board};
-            return nnue::Evaluator<NNUEChessInterface>::fullEvaluate(network, intf);
+        switch(level) {
+#ifdef JCHESS_NNUE_X86
+            case SimdLevel::SSE2:
+                return sse2::hidden_layer_products(input, weights, biases);
+            case SimdLevel::SSSE3:
+                return ssse3::hidden_layer_products(input, weights, biases);
+            case SimdLevel::AVX2:
+                return avx2::hidden_layer_products(input, weights, biases);
+            case SimdLevel::AVX512:
+                return avx512::hidden_layer_products(input, weights, biases);
+#endif
+#ifdef JCHESS_NNUE_NEON
+            case SimdLevel::NEON:
+                return neon::hidden_layer_products(input, weights, biases);
+#endif
+            default:
+                return generic::hidden_layer_products(input, weights, biases);
         }
-    private:
-        nnue::Network network;
-    };
+    }
+
+    NNUEEvaluator::NNUEEvaluator(std::string const& network_file) : NNUEEvaluator(network_file, best_simd_level()) {}
 
-    NNUEEvaluator::NNUEEvaluator(std::string const& network_file) {
-        pimpl = std::make_unique<impl>(network_file);
+    NNUEEvaluator::NNUEEvaluator(std::string const& network_file, SimdLevel level) : simd_level{level} {
+        if(!simd_level_available(level)) {
+            throw std::runtime_error(std::string("nnue: instruction set not available: ") + std::string(simd_level_name(level)));
+        }
+        backend = make_backend(level, network_file);
     }
 
     // stop compiler generating a destructor which complains about incomplete type
     NNUEEvaluator::~NNUEEvaluator() {}
 
     int32_t NNUEEvaluator::nnue_eval_fen(std::string const& fen) {
-        return pimpl->nnue_eval_fen(fen);
+        return nnue_eval_board(jchess::Board{fen});
     }
 
     int32_t NNUEEvaluator::nnue_eval_board(jchess::Board const& board) {
-        return pimpl->nnue_eval_board(board);
+        return backend->nnue_eval_board(board);
+    }
+
+    int32_t NNUEEvaluator::nnue_eval_board_full(jchess::Board const& board) const {
+        return backend->nnue_eval_full(board);
+    }
+
+    uint64_t NNUEEvaluator::get_refresh_table_hits() const {
+        return backend->refresh_table_hits();
+    }
+
+    void NNUEEvaluator::write_network_image(std::string const& image_file) const {
+        backend->write_image(image_file);
+    }
+
+    bool NNUEEvaluator::is_network_mapped() const {
+        return backend->is_mapped();
+    }
+
+    std::string NNUEEvaluator::get_architecture() const {
+        return backend->architecture();
+    }
+
+    BatchStats NNUEEvaluator::nnue_eval_batch(std::span<PackedPosition const> positions, std::span<int32_t> evals, int num_threads) {
+        if(evals.size() != positions.size()) {
+            throw std::invalid_argument("nnue: need one eval per position");
+        }
+        if(num_threads <= 0) {
+            num_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        }
+        num_threads = static_cast<int>(std::clamp<size_t>(num_threads, 1, std::max<size_t>(1, positions.size())));
+        auto start = std::chrono::steady_clock::now();
+        backend->eval_batch(positions, evals, num_threads);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return {.positions = positions.size(), .threads = num_threads, .elapsed_seconds = elapsed.count()};
+    }
+
+    BatchStats NNUEEvaluator::nnue_eval_batch(std::span<Board const> boards, std::span<int32_t> evals, int num_threads) {
+        std::vector<PackedPosition> positions(boards.begin(), boards.end());
+        return nnue_eval_batch(positions, evals, num_threads);
     }
 }
\ No newline at end of file
@@ -2,17 +2,78 @@
 
 #include "../board.h"
 #include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
 
 namespace jchess::nnue_eval {
+    class NNUEBackend;
+
+    // instruction sets the network can be evaluated with, in increasing order of preference.
+    enum class SimdLevel { GENERIC, SSE2, SSSE3, AVX2, AVX512, NEON };
+
+    std::string_view simd_level_name(SimdLevel level);
+    // compiled in, and supported by the cpu we are running on.
+    bool simd_level_available(SimdLevel level);
+    SimdLevel best_simd_level();
+
+    // a position without the move history of a Board, for evaluating many positions at once.
+    struct PackedPosition {
+        PackedPosition(FEN const& fen) : state{fen}, side_to_move{fen.side_to_move} {}
+        PackedPosition(Board const& board) : state{board.get_board_state()}, side_to_move{board.get_side_to_move()} {}
+        BoardState state;
+        Color side_to_move;
+    };
+
+    struct BatchStats {
+        size_t positions = 0;
+        int threads = 0;
+        double elapsed_seconds = 0.0;
+        double positions_per_second() const { return elapsed_seconds > 0.0 ? positions / elapsed_seconds : 0.0; }
+    };
+
+    // the first hidden layer of the default network, which sees the clamped accumulator and is mostly fed zeros.
+    constexpr size_t HIDDEN_LAYER_INPUTS = 512;
+    constexpr size_t HIDDEN_LAYER_OUTPUTS = 32;
+
+    struct HiddenLayerProducts {
+        std::vector<int32_t> sparse;
+        std::vector<int32_t> dense;
+    };
+
+    // the first hidden layer's outputs for input by the kernel that skips zero inputs and by the one that doesn't,
+    // for testing that they agree. weights are by output then input. throws if the level isn't available.
+    HiddenLayerProducts hidden_layer_products(SimdLevel level, std::span<uint8_t const> input,
+                                              std::span<int8_t const> weights, std::span<int32_t const> biases);
+
     class NNUEEvaluator {
     public:
+        // network_filename is a network file, or an image written by write_network_image
         NNUEEvaluator(std::string const& network_filename);
+        // throws if the level isn't available
+        NNUEEvaluator(std::string const& network_filename, SimdLevel level);
         ~NNUEEvaluator();
         int32_t nnue_eval_fen(std::string const& fen);
         int32_t nnue_eval_board(jchess::Board const& board);
+        // from scratch, without the accumulators kept between calls or the refresh table, to check them against.
+        int32_t nnue_eval_board_full(jchess::Board const& board) const;
+        // how many accumulator refreshes by nnue_eval_board started from a refresh table entry.
+        uint64_t get_refresh_table_hits() const;
+        // evals[i] is the evaluation of positions[i], the same as nnue_eval_board would give. Shares the
+        // network between num_threads threads (0 for one per core). Doesn't touch the state used by
+        // nnue_eval_board, but isn't thread safe with it.
+        BatchStats nnue_eval_batch(std::span<PackedPosition const> positions, std::span<int32_t> evals, int num_threads = 0);
+        BatchStats nnue_eval_batch(std::span<Board const> boards, std::span<int32_t> evals, int num_threads = 0);
+        SimdLevel get_simd_level() const { return simd_level; }
+        // the network in its in-memory layout, which can be passed to the constructor instead of the
+        // network file and is mapped rather than read. Only valid on a host with the same byte order.
+        void write_network_image(std::string const& image_file) const;
+        bool is_network_mapped() const;
+        // the network architecture, chosen by the network file, e.g. halfkp_256x2-32-32
+        std::string get_architecture() const;
     private:
         // avoid the jdart nnue headers being part of the library's public interface
-        class impl;
-        std::unique_ptr<impl> pimpl;
+        std::unique_ptr<NNUEBackend> backend;
+        SimdLevel simd_level;
     };
 }
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include "pawns.h"
+#include "bitboard.h"
+
+#include <bit>
+#include <cassert>
+
+namespace jchess {
+    namespace {
+        // indexed by the rank of the pawn from its own side's point of view.
+        constexpr TaperedScore PASSED_BONUS[8] = {
+            {0, 0}, {5, 10}, {10, 17}, {15, 30}, {30, 55}, {55, 95}, {90, 150}, {0, 0}
+        };
+        constexpr TaperedScore ISOLATED_PENALTY {-10, -15};
+        constexpr TaperedScore DOUBLED_PENALTY {-10, -25};
+        constexpr TaperedScore BACKWARD_PENALTY {-8, -12};
+        // indexed by how far in front of the king the closest friendly pawn on a file is, 0 if there isn't one.
+        constexpr int SHELTER_BONUS[8] = {-20, 15, 8, 2, -5, -10, -15, -20};
+
+        constexpr int relative_rank(Square square, Color color) {
+            return (color == WHITE) ? rank_of(square) : RANK_8 - rank_of(square);
+        }
+
+        void add_term(TaperedScore& score, TaperedScore term) {
+            score.mg += term.mg;
+            score.eg += term.eg;
+        }
+
+        int compute_shelter(Bitboard own_pawns, Square king_sq, Color color) {
+            int king_file = file_of(king_sq);
+            int shelter = 0;
+            for(int file = std::max(king_file - 1, 0); file <= std::min(king_file + 1, 7); ++file) {
+                Square on_king_rank = square_from_rank_file(rank_of(king_sq), file);
+                Bitboard in_front = own_pawns & FORWARD_FILE_BBS[color][on_king_rank];
+                if(!in_front) {
+                    shelter += SHELTER_BONUS[0];
+                    continue;
+                }
+                auto closest = static_cast<Square>(bit_scan(in_front, color == BLACK));
+                shelter += SHELTER_BONUS[vertical_distance(closest, king_sq)];
+            }
+            return shelter;
+        }
+    }
+
+    void compute_pawn_entry(PawnEntry& entry, BoardState const& state) {
+        entry.key = state.pawn_key;
+        for(Color color : {WHITE, BLACK}) {
+            Bitboard own = state.piece_bb(PAWN, color);
+            Bitboard enemy = state.piece_bb(PAWN, !color);
+            Direction push_dir = (color == WHITE) ? NORTH : SOUTH;
+            TaperedScore score;
+            Bitboard attacks = 0ull, spans = 0ull, passed = 0ull;
+
+            Bitboard pawns = own;
+            Square sq;
+            while(pop_lsb_square(pawns, sq)) {
+                attacks |= PAWN_ATTACKS[color][sq];
+                spans |= PAWN_ATTACK_SPANS[color][sq];
+
+                Bitboard neighbours = own & ADJACENT_FILE_BBS[file_of(sq)];
+                bool doubled = own & FORWARD_FILE_BBS[color][sq];
+                bool isolated = !neighbours;
+                // no friendly pawn level with or behind it can ever defend it, and it can't safely advance.
+                bool backward = !isolated
+                    && !(neighbours & ~FORWARD_RANK_BBS[color][rank_of(sq)])
+                    && (PAWN_ATTACKS[color][sq + push_dir] & enemy);
+                // only the front pawn of a doubled pair counts as passed.
+                bool is_passed = !doubled && !(enemy & (FORWARD_FILE_BBS[color][sq] | PAWN_ATTACK_SPANS[color][sq]));
+
+                if(doubled) {
+                    add_term(score, DOUBLED_PENALTY);
+                }
+                if(isolated) {
+                    add_term(score, ISOLATED_PENALTY);
+                } else if(backward) {
+                    add_term(score, BACKWARD_PENALTY);
+                }
+                if(is_passed) {
+                    bb_add_square(passed, sq);
+                    add_term(score, PASSED_BONUS[relative_rank(sq, color)]);
+                }
+            }
+
+            entry.score[color] = score;
+            entry.pawn_attacks[color] = attacks;
+            entry.pawn_attack_spans[color] = spans;
+            entry.passed_pawns[color] = passed;
+            entry.shelter_king_sq[color] = NUM_SQUARES;
+        }
+    }
+
+    int PawnEntry::king_shelter(BoardState const& state, Color color) {
+        Square king_sq = state.king_sq[color];
+        if(shelter_king_sq[color] != king_sq) {
+            shelter_king_sq[color] = king_sq;
+            shelter[color] = compute_shelter(state.piece_bb(PAWN, color), king_sq, color);
+        }
+        return shelter[color];
+    }
+
+    PawnHashTable::PawnHashTable(size_t num_entries) : entries(num_entries) {
+        assert(std::has_single_bit(num_entries));
+    }
+
+    PawnEntry& PawnHashTable::probe(BoardState const& state) {
+        // a pawnless position has key 0, which is also what an empty entry computes to.
+        PawnEntry& entry = entries[state.pawn_key & (entries.size() - 1)];
+        if(entry.key == state.pawn_key) {
+            ++hits;
+            return entry;
+        }
+        ++misses;
+        compute_pawn_entry(entry, state);
+        return entry;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "board_state.h"
+
+#include <vector>
+
+namespace jchess {
+    namespace detail {
+        constexpr size_t DEFAULT_PAWN_TABLE_ENTRIES = 1 << 14; // must be a power of 2
+    }
+
+    // everything about a position that only depends on where the pawns are.
+    struct PawnEntry {
+        uint64_t key = 0;
+        TaperedScore score[2]; // white/black pawn structure
+        Bitboard pawn_attacks[2] = {};
+        Bitboard pawn_attack_spans[2] = {}; // every square the pawns could attack if pushed
+        Bitboard passed_pawns[2] = {};
+        int king_shelter(BoardState const& state, Color color);
+    private:
+        // the shelter also depends on the king square, so it is computed on demand and cached per king square.
+        Square shelter_king_sq[2] = {NUM_SQUARES, NUM_SQUARES};
+        int shelter[2] = {};
+        friend void compute_pawn_entry(PawnEntry& entry, BoardState const& state);
+    };
+
+    void compute_pawn_entry(PawnEntry& entry, BoardState const& state);
+
+    // pawn structure rarely changes between nodes, so the hit rate is very high.
+    class PawnHashTable {
+    public:
+        explicit PawnHashTable(size_t num_entries = detail::DEFAULT_PAWN_TABLE_ENTRIES);
+        PawnEntry& probe(BoardState const& state);
+        uint64_t num_hits() const { return hits; }
+        uint64_t num_misses() const { return misses; }
+    private:
+        std::vector<PawnEntry> entries;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,218 @@
+#include "perft.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace jchess {
+    namespace {
+        // a root move and one reply to it, or no reply when the root move alone is the whole job.
+        struct PerftTask {
+            int root_index = 0;
+            Move reply = NULL_MOVE;
+        };
+
+        // a queue per worker, each takes from the back of its own and steals from the front of the others'.
+        // every task is pushed before the workers start, so a worker is finished once every queue is empty.
+        class WorkStealingQueues {
+        public:
+            explicit WorkStealingQueues(int num_queues) : queues(num_queues) {}
+
+            void push(int queue, PerftTask const& task) {
+                std::lock_guard lock{queues[queue].mutex};
+                queues[queue].tasks.push_back(task);
+            }
+
+            std::optional<PerftTask> pop(int queue) {
+                for(size_t i = 0; i < queues.size(); ++i) {
+                    Queue& victim = queues[(queue + i) % queues.size()];
+                    std::lock_guard lock{victim.mutex};
+                    if(victim.tasks.empty()) {
+                        continue;
+                    }
+                    PerftTask task;
+                    if(i == 0) {
+                        task = victim.tasks.back();
+                        victim.tasks.pop_back();
+                    } else {
+                        task = victim.tasks.front();
+                        victim.tasks.pop_front();
+                    }
+                    return task;
+                }
+                return std::nullopt;
+            }
+        private:
+            struct Queue {
+                std::mutex mutex;
+                std::deque<PerftTask> tasks;
+            };
+            std::vector<Queue> queues;
+        };
+
+        // counted per thread and summed at the end, shared counters would be contended on every probe.
+        struct alignas(64) TableStats {
+            uint64_t probes = 0;
+            uint64_t hits = 0;
+        };
+
+        uint64_t perft_with_table(Board& board, int depth, PerftTable& table, TableStats& stats) {
+            if(depth <= 1) {
+                return perft(board, depth); // cheaper to count than to look up
+            }
+            uint64_t key = board.get_key();
+            ++stats.probes;
+            if(auto nodes = table.probe(key, depth)) {
+                ++stats.hits;
+                return nodes.value();
+            }
+            MoveVector moves;
+            board.generate_legal_moves(moves);
+            uint64_t nodes = 0ull;
+            for(Move const& move : moves) {
+                board.make_move(move);
+                nodes += perft_with_table(board, depth - 1, table, stats);
+                board.unmake_move();
+            }
+            table.store(key, depth, nodes);
+            return nodes;
+        }
+    }
+
+    PerftTable::PerftTable(size_t size_mb) {
+        // a power of 2 buckets so the key can be masked, rounded down to fit the size asked for.
+        size_t bytes = std::max(size_mb << 20, sizeof(Bucket));
+        num_buckets = std::bit_floor(bytes / sizeof(Bucket));
+        buckets = std::make_unique<Bucket[]>(num_buckets);
+    }
+
+    std::optional<uint64_t> PerftTable::probe(uint64_t key, int depth) const {
+        for(Entry const& entry : buckets[key & (num_buckets - 1)].entries) {
+            uint64_t data = entry.data.load(std::memory_order_relaxed);
+            uint64_t check = entry.check.load(std::memory_order_relaxed);
+            if((check ^ data) == key && static_cast<int>(data & 0xFF) == depth) {
+                return data >> 8;
+            }
+        }
+        return std::nullopt;
+    }
+
+    void PerftTable::store(uint64_t key, int depth, uint64_t nodes) {
+        auto& bucket = buckets[key & (num_buckets - 1)].entries;
+        // the first slot only gives way to a subtree at least as deep, the second always does.
+        int first_depth = static_cast<int>(bucket[0].data.load(std::memory_order_relaxed) & 0xFF);
+        Entry& entry = (depth >= first_depth) ? bucket[0] : bucket[1];
+        uint64_t data = (nodes << 8) | static_cast<uint64_t>(depth);
+        entry.check.store(key ^ data, std::memory_order_relaxed);
+        entry.data.store(data, std::memory_order_relaxed);
+    }
+
+    void PerftTable::clear() {
+        for(size_t i = 0; i < num_buckets; ++i) {
+            for(Entry& entry : buckets[i].entries) {
+                entry.check.store(0, std::memory_order_relaxed);
+                entry.data.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    uint64_t perft(Board& board, int depth) {
+        assert(depth >= 0);
+        if(depth == 0) {
+            return 1ull;
+        }
+        MoveVector moves;
+        board.generate_legal_moves(moves);
+        if(depth == 1) {
+            return moves.size();
+        }
+        uint64_t nodes = 0ull;
+        for(Move const& move : moves) {
+            board.make_move(move);
+            nodes += perft(board, depth - 1);
+            board.unmake_move();
+        }
+        return nodes;
+    }
+
+    PerftResult perft_divide(Board const& board, int depth, int num_threads, PerftTable* table) {
+        assert(depth >= 1);
+        Board root = board;
+        MoveVector root_moves;
+        root.generate_legal_moves(root_moves);
+        PerftResult result;
+        if(depth == 1) {
+            for(Move const& move : root_moves) {
+                result.divide.emplace_back(move, 1ull);
+            }
+            result.nodes = root_moves.size();
+            return result;
+        }
+
+        if(num_threads <= 0) {
+            num_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        }
+        // a few dozen root moves are too few to keep every thread busy until the end, splitting on the
+        // replies as well gives hundreds.
+        WorkStealingQueues queues{num_threads};
+        int next_queue = 0;
+        for(int i = 0; i < static_cast<int>(root_moves.size()); ++i) {
+            if(depth >= 3) {
+                MoveVector replies;
+                root.make_move(root_moves[i]);
+                root.generate_legal_moves(replies);
+                root.unmake_move();
+                for(Move const& reply : replies) {
+                    queues.push(next_queue++ % num_threads, PerftTask{i, reply});
+                }
+            } else {
+                queues.push(next_queue++ % num_threads, PerftTask{i});
+            }
+        }
+
+        std::vector<std::atomic<uint64_t>> counts(root_moves.size());
+        std::vector<TableStats> stats(num_threads);
+        auto worker = [&](int id) {
+            Board local = root; // boards aren't thread safe, not even to generate moves
+            auto count = [&](int sub_depth) {
+                return table ? perft_with_table(local, sub_depth, *table, stats[id]) : perft(local, sub_depth);
+            };
+            while(auto task = queues.pop(id)) {
+                local.make_move(root_moves[task->root_index]);
+                uint64_t nodes;
+                if(task->reply.is_null_move()) {
+                    nodes = count(depth - 1);
+                } else {
+                    local.make_move(task->reply);
+                    nodes = count(depth - 2);
+                    local.unmake_move();
+                }
+                local.unmake_move();
+                counts[task->root_index] += nodes;
+            }
+        };
+        std::vector<std::thread> threads;
+        for(int id = 1; id < num_threads; ++id) {
+            threads.emplace_back(worker, id);
+        }
+        worker(0);
+        for(auto& thread : threads) {
+            thread.join();
+        }
+
+        for(size_t i = 0; i < root_moves.size(); ++i) {
+            result.divide.emplace_back(root_moves[i], counts[i].load());
+            result.nodes += counts[i];
+        }
+        for(TableStats const& thread_stats : stats) {
+            result.table_probes += thread_stats.probes;
+            result.table_hits += thread_stats.hits;
+        }
+        return result;
+    }
+}
\ No newline at end of file
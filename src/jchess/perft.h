@@ -0,0 +1,52 @@
+#pragma once
+
+#include "board.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace jchess {
+    namespace detail {
+        constexpr size_t DEFAULT_PERFT_TABLE_MB = 64;
+    }
+
+    // subtree counts by position key and depth, shared between threads without locks. each slot stores the
+    // key xor'd with its data next to the data, so a slot torn by two threads writing at once fails the
+    // full key check rather than giving a wrong count. two slots per bucket, one keeps the deepest subtree.
+    class PerftTable {
+    public:
+        explicit PerftTable(size_t size_mb = detail::DEFAULT_PERFT_TABLE_MB);
+        std::optional<uint64_t> probe(uint64_t key, int depth) const;
+        void store(uint64_t key, int depth, uint64_t nodes);
+        void clear();
+        size_t num_entries() const { return 2 * num_buckets; }
+    private:
+        struct Entry {
+            std::atomic<uint64_t> check {0}; // key ^ data
+            std::atomic<uint64_t> data {0}; // nodes << 8 | depth, a depth of 0 is never stored
+        };
+        struct Bucket {
+            std::array<Entry, 2> entries;
+        };
+        std::unique_ptr<Bucket[]> buckets;
+        size_t num_buckets = 0;
+    };
+
+    struct PerftResult {
+        uint64_t nodes = 0;
+        std::vector<std::pair<Move, uint64_t>> divide; // the nodes under each root move, in generation order
+        uint64_t table_probes = 0;
+        uint64_t table_hits = 0;
+    };
+
+    // leaves are bulk counted at depth 1 from the size of the move list rather than made.
+    uint64_t perft(Board& board, int depth);
+    // the root moves, and their replies if deep enough to be worth it, are split across threads that steal
+    // from each other once their own queue runs dry. num_threads <= 0 uses every core. subtrees are looked
+    // up in and added to the table if one is given, it can be kept between calls.
+    PerftResult perft_divide(Board const& board, int depth, int num_threads = 0, PerftTable* table = nullptr);
+}
\ No newline at end of file
@@ -99,7 +99,7 @@ namespace jchess::polyglot {
             }
         }
 
-        return {src, dest, promotion};
+        return move_from_squares(board.get_board_state(), src, dest, promotion);
     }
 
     PGMappedBook::PGMappedBook(std::string const& pg_book_path) {
@@ -12,7 +12,7 @@ namespace jchess {
     SearchInfo Searcher::iterative_deepening_search(Board& board, int max_depth, MoveVector const& root_restrict_moves) {
         using namespace std::chrono;
         for(int depth=1; depth<=max_depth; ++depth) {
-            Move iteration_best{"0000"};
+            Move iteration_best = NULL_MOVE;
             search_info.num_nodes = 0;
             auto t1 = Searcher::Clock::now();
             Score score = alpha_beta_search(depth, board, MIN_SCORE, MAX_SCORE, iteration_best, true, root_restrict_moves);
@@ -78,23 +78,24 @@ namespace jchess {
         os << "best: " << move_to_string(info.best_move) <<
             " nodes: " << info.num_nodes <<
             " time(micros): " << info.time_micros <<
-            " depth: " << info.depth;
+            " depth: " << info.depth <<
+            " lazy eval hits: " << info.lazy_eval_hits <<
+            " misses: " << info.lazy_eval_misses;
         return os;
     }
 
     int move_ordering_rank(const Move &move, Board const& board) {
         // checks > "good" captures > quiet > "bad" captures
-        auto state = board.get_board_state();
-        auto color = board.get_side_to_move();
-        PieceType src_type = type_from_piece(state.pieces[move.source]);
+        auto const& state = board.get_board_state();
+        PieceType src_type = type_from_piece(state.pieces[move.source()]);
         int check_weight = 0, capture_weight = 0;
         // checks
-        if(is_attack(move.dest, state.king_sq[!color], src_type, color, state)) {
+        if(board.gives_check(move)) {
             check_weight = 2;
         }
         // captures
-        if(state.pieces[move.dest] != NO_PIECE) {
-            PieceType dest_type = type_from_piece(state.pieces[move.dest]);
+        if(state.pieces[move.dest()] != NO_PIECE) {
+            PieceType dest_type = type_from_piece(state.pieces[move.dest()]);
             //  PAWN, ROOK, KNIGHT, BISHOP, KING, QUEEN
             int type_ranks[6] = {1, 3, 2, 2, 5, 4}; // higher means better piece
             capture_weight = type_ranks[dest_type] - type_ranks[src_type]; // [-4, 4] range
@@ -165,27 +166,30 @@ namespace jchess {
             return DRAW_SCORE; // can get a stalemate through 3fold repetition
         }
 
+        // no need to search a position neither side can win, except at the root where we need a move.
+        if(!root && material_table.probe(board.get_board_state()).insufficient_material) {
+            return DRAW_SCORE;
+        }
+
         MoveVector moves;
         if(root && !root_restrict_moves.empty()) {
             moves = root_restrict_moves;
         } else {
-            board.generate_legal_moves(moves);
-        }
-        search_info.num_nodes += moves.size(); // doesn't make sense to do this here
-
-        if(moves.empty()) {
-            if(board.in_check()) {
-                return MIN_SCORE; // checkmate
-            } else {
-                return DRAW_SCORE; // stalemate
-            }
+            // legality is only checked for the moves we get to before a cutoff.
+            board.generate_pseudo_legal_moves(moves);
         }
 
         std::sort(moves.begin(), moves.end(), [&board](Move lhs, Move rhs){
             return move_ordering_rank(lhs, board) > move_ordering_rank(rhs, board);
         });
         prev_pos_hashes.insert(board_hash);
+        bool any_legal_move = false;
         for(const Move& move : moves) {
+            if(!board.is_legal(move)) {
+                continue;
+            }
+            any_legal_move = true;
+            ++search_info.num_nodes;
             board.make_move(move);
             Score score = -alpha_beta_search(depth - 1, board, -beta, -alpha, best_move);
             board.unmake_move();
@@ -215,6 +219,13 @@ namespace jchess {
         }
         prev_pos_hashes.erase(board_hash);
 
+        if(!any_legal_move) {
+            if(board.in_check()) {
+                return MIN_SCORE; // checkmate
+            } else {
+                return DRAW_SCORE; // stalemate
+            }
+        }
         return alpha;
     }
     
@@ -223,16 +234,38 @@ namespace jchess {
             search_info.terminated = true;
             return 0;
         }
-        Score score = nnue_eval ? nnue_eval->nnue_eval_board(board) : eval(board);
+        // the specialised endgame evals know things neither the classical eval nor the network do.
+        MaterialEntry& material = material_table.probe(board.get_board_state());
+        if(material.insufficient_material) {
+            return DRAW_SCORE;
+        }
+        Score score;
+        if(material.has_endgame_eval()) {
+            score = material.endgame_eval(board.get_board_state(), board.get_side_to_move());
+        } else {
+            score = eval(board, pawn_table, material_table);
+            // the network is far more expensive than the classical eval and only matters near the window.
+            if(nnue_eval) {
+                if(score - lazy_eval_margin >= beta || score + lazy_eval_margin <= alpha) {
+                    ++search_info.lazy_eval_hits;
+                } else {
+                    ++search_info.lazy_eval_misses;
+                    score = nnue_eval->nnue_eval_board(board);
+                }
+            }
+        }
         if(score >= beta) {
             return beta;
         }
         alpha = std::max(alpha, score);
 
         MoveVector moves;
-        board.generate_legal_moves(moves, GenPolicy::ONLY_CAPTURES);
+        board.generate_pseudo_legal_moves(moves, GenType::CAPTURES);
 
         for(const Move& move : moves) {
+            if(!board.is_legal(move)) {
+                continue;
+            }
             board.make_move(move);
             score = -quiesence_search(-beta, -alpha, board);
             board.unmake_move();
@@ -18,6 +18,8 @@ namespace jchess {
 
     constexpr Score DRAW_SCORE = 0;
     constexpr int DEFAULT_MAX_DEPTH = 10;
+    // how far outside the window the classical eval has to be for quiesence to skip the network.
+    constexpr Score DEFAULT_LAZY_EVAL_MARGIN = 350;
 
     struct SearchLimits {
         long long max_time_ms = 0; // milliseconds
@@ -31,7 +33,7 @@ namespace jchess {
     std::ostream& operator<<(std::ostream& os, SearchLimits const& limits);
 
     struct SearchInfo {
-        Move best_move {"0000"};
+        Move best_move = NULL_MOVE;
         MoveVector pv;
         Score score;
         std::optional<int> mate_depth;
@@ -39,6 +41,8 @@ namespace jchess {
         uint64_t time_micros = 0;
         bool terminated = false;
         int depth = 0;
+        uint64_t lazy_eval_hits = 0; // network evaluations skipped because the classical eval was far outside the window
+        uint64_t lazy_eval_misses = 0; // network evaluations done
     };
 
     std::ostream& operator<<(std::ostream& os, SearchInfo const& info);
@@ -51,6 +55,7 @@ namespace jchess {
         SearchInfo search(Board& board, SearchLimits const& limits);
         void search_mt(Board& board, SearchLimits limits);
         void enable_nnue_eval(std::unique_ptr<nnue_eval::NNUEEvaluator>&& nnue_eval);
+        void set_lazy_eval_margin(Score margin) { lazy_eval_margin = margin; }
         Score alpha_beta_search(int depth, Board& board, Score alpha, Score beta, Move& best_move, bool root = false, MoveVector const& root_restrict_moves = {});
         void stop_mt_search();
         void ponderhit();
@@ -66,6 +71,9 @@ namespace jchess {
         SearchInfo search_info {};
         std::unordered_set<uint64_t> prev_pos_hashes;
         std::unique_ptr<nnue_eval::NNUEEvaluator> nnue_eval = nullptr;
+        Score lazy_eval_margin = DEFAULT_LAZY_EVAL_MARGIN;
+        PawnHashTable pawn_table {};
+        MaterialHashTable material_table {};
         // multithreaded search
         std::mutex mut;
         std::condition_variable cv;
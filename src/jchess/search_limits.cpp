@@ -12,10 +12,14 @@ namespace jchess {
         return std::min(max_time, time_ll);
     }
 
-    void limits_from_uci_go(SearchLimits& limits, UciGo const& uci_go, Color color) {
+    void limits_from_uci_go(SearchLimits& limits, UciGo const& uci_go, Board const& board) {
+        Color color = board.get_side_to_move();
         limits.max_nodes = (uci_go.nodes == -1) ? -1ull : uci_go.nodes;
         limits.depth = uci_go.depth;
-        limits.search_moves = uci_go.search_moves;
+        limits.search_moves.clear();
+        for(std::string const& move : uci_go.search_moves) {
+            limits.search_moves.push_back(move_from_uci(board, move));
+        }
         limits.infinite = uci_go.infinite;
         limits.ponder = uci_go.ponder;
         limits.max_time_ms = uci_go.movetime;
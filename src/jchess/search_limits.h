@@ -5,6 +5,6 @@
 #include "board.h"
 
 namespace jchess {
-    void limits_from_uci_go(SearchLimits& limits, UciGo const& uci_go, Color color);
+    void limits_from_uci_go(SearchLimits& limits, UciGo const& uci_go, Board const& board);
     long long compute_time_to_search_msec(int my_time, int op_time, int my_inc, int op_inc);
 }
\ No newline at end of file
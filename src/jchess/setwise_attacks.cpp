@@ -0,0 +1,92 @@
+#include "setwise_attacks.h"
+
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define JCHESS_SETWISE_X86
+#include <immintrin.h>
+#endif
+
+namespace jchess {
+    namespace {
+        using SliderAttacksFn = Bitboard (*)(Bitboard, Bitboard, Bitboard);
+
+#ifdef JCHESS_SETWISE_X86
+        // the four directions that shift left (north, east, north east, north west) share one vector,
+        // the four that shift right (south, west, south west, south east) the other.
+        __attribute__((target("avx2"))) Bitboard slider_attacks_avx2(Bitboard orth_sliders, Bitboard diag_sliders, Bitboard occupied) {
+            const __m256i shift = _mm256_setr_epi64x(8, 1, 9, 7);
+            const __m256i shift2 = _mm256_slli_epi64(shift, 1);
+            const __m256i shift4 = _mm256_slli_epi64(shift, 2);
+            const __m256i wrap_left = _mm256_setr_epi64x(~0ll, notAFile, notAFile, notHFile);
+            const __m256i wrap_right = _mm256_setr_epi64x(~0ll, notHFile, notHFile, notAFile);
+            const __m256i empty = _mm256_set1_epi64x(~occupied);
+
+            __m256i gen_left = _mm256_setr_epi64x(orth_sliders, orth_sliders, diag_sliders, diag_sliders);
+            __m256i gen_right = gen_left;
+            __m256i pro_left = _mm256_and_si256(empty, wrap_left);
+            __m256i pro_right = _mm256_and_si256(empty, wrap_right);
+
+            gen_left = _mm256_or_si256(gen_left, _mm256_and_si256(pro_left, _mm256_sllv_epi64(gen_left, shift)));
+            gen_right = _mm256_or_si256(gen_right, _mm256_and_si256(pro_right, _mm256_srlv_epi64(gen_right, shift)));
+            pro_left = _mm256_and_si256(pro_left, _mm256_sllv_epi64(pro_left, shift));
+            pro_right = _mm256_and_si256(pro_right, _mm256_srlv_epi64(pro_right, shift));
+            gen_left = _mm256_or_si256(gen_left, _mm256_and_si256(pro_left, _mm256_sllv_epi64(gen_left, shift2)));
+            gen_right = _mm256_or_si256(gen_right, _mm256_and_si256(pro_right, _mm256_srlv_epi64(gen_right, shift2)));
+            pro_left = _mm256_and_si256(pro_left, _mm256_sllv_epi64(pro_left, shift2));
+            pro_right = _mm256_and_si256(pro_right, _mm256_srlv_epi64(pro_right, shift2));
+            gen_left = _mm256_or_si256(gen_left, _mm256_and_si256(pro_left, _mm256_sllv_epi64(gen_left, shift4)));
+            gen_right = _mm256_or_si256(gen_right, _mm256_and_si256(pro_right, _mm256_srlv_epi64(gen_right, shift4)));
+
+            __m256i attacks = _mm256_or_si256(
+                _mm256_and_si256(_mm256_sllv_epi64(gen_left, shift), wrap_left),
+                _mm256_and_si256(_mm256_srlv_epi64(gen_right, shift), wrap_right));
+            __m128i half = _mm_or_si128(_mm256_castsi256_si128(attacks), _mm256_extracti128_si256(attacks, 1));
+            return _mm_cvtsi128_si64(_mm_or_si128(half, _mm_unpackhi_epi64(half, half)));
+        }
+#endif
+
+        SliderAttacksFn slider_attacks_impl = detail::slider_attacks_scalar;
+        SetwiseBackend setwise_backend = SetwiseBackend::SCALAR;
+
+        const bool setwise_backend_initialised = [] {
+            set_setwise_backend(setwise_backend_available(SetwiseBackend::AVX2) ? SetwiseBackend::AVX2 : SetwiseBackend::SCALAR);
+            return true;
+        }();
+    }
+
+    std::string_view setwise_backend_name(SetwiseBackend backend) {
+        return backend == SetwiseBackend::AVX2 ? "avx2" : "scalar";
+    }
+
+    bool setwise_backend_available(SetwiseBackend backend) {
+        if (backend == SetwiseBackend::SCALAR) {
+            return true;
+        }
+#ifdef JCHESS_SETWISE_X86
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+
+    SetwiseBackend get_setwise_backend() {
+        return setwise_backend;
+    }
+
+    void set_setwise_backend(SetwiseBackend backend) {
+        if (!setwise_backend_available(backend)) {
+            throw std::runtime_error(std::string("setwise attacks: backend not available: ") + std::string(setwise_backend_name(backend)));
+        }
+#ifdef JCHESS_SETWISE_X86
+        slider_attacks_impl = backend == SetwiseBackend::AVX2 ? slider_attacks_avx2 : detail::slider_attacks_scalar;
+#endif
+        setwise_backend = backend;
+    }
+
+    Bitboard get_slider_attacks_setwise(Bitboard orth_sliders, Bitboard diag_sliders, Bitboard occupied) {
+        return slider_attacks_impl(orth_sliders, diag_sliders, occupied);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "bitboard.h"
+
+#include <string_view>
+
+namespace jchess {
+    // attacks of a whole set of sliders at once with Kogge-Stone fills instead of a magic lookup per piece.
+    // https://www.chessprogramming.org/Kogge-Stone_Algorithm
+    enum class SetwiseBackend { SCALAR, AVX2 };
+
+    std::string_view setwise_backend_name(SetwiseBackend backend);
+    bool setwise_backend_available(SetwiseBackend backend);
+    // chosen at startup, avx2 if the cpu has it.
+    SetwiseBackend get_setwise_backend();
+    // not thread safe, only call this when nothing is searching. throws if the cpu can't use the backend.
+    void set_setwise_backend(SetwiseBackend backend);
+
+    // every square attacked by the rooks/queens in orth_sliders and the bishops/queens in diag_sliders.
+    Bitboard get_slider_attacks_setwise(Bitboard orth_sliders, Bitboard diag_sliders, Bitboard occupied);
+
+    namespace detail {
+        // gen slides towards positive (left shift) or negative squares until it hits something not in pro,
+        // wrap stops it leaving one edge of the board and coming back on the other.
+        constexpr Bitboard shift_bb(Bitboard bb, int shift) {
+            return shift > 0 ? bb << shift : bb >> -shift;
+        }
+
+        constexpr Bitboard kogge_stone_attacks(Bitboard gen, Bitboard pro, int shift, Bitboard wrap) {
+            pro &= wrap;
+            gen |= pro & shift_bb(gen, shift);
+            pro &= shift_bb(pro, shift);
+            gen |= pro & shift_bb(gen, 2 * shift);
+            pro &= shift_bb(pro, 2 * shift);
+            gen |= pro & shift_bb(gen, 4 * shift);
+            return shift_bb(gen, shift) & wrap;
+        }
+
+        constexpr Bitboard slider_attacks_scalar(Bitboard orth_sliders, Bitboard diag_sliders, Bitboard occupied) {
+            Bitboard empty = ~occupied;
+            return kogge_stone_attacks(orth_sliders, empty, 8, ~0ull)       // north
+                 | kogge_stone_attacks(orth_sliders, empty, -8, ~0ull)      // south
+                 | kogge_stone_attacks(orth_sliders, empty, 1, notAFile)    // east
+                 | kogge_stone_attacks(orth_sliders, empty, -1, notHFile)   // west
+                 | kogge_stone_attacks(diag_sliders, empty, 9, notAFile)    // north east
+                 | kogge_stone_attacks(diag_sliders, empty, 7, notHFile)    // north west
+                 | kogge_stone_attacks(diag_sliders, empty, -7, notAFile)   // south east
+                 | kogge_stone_attacks(diag_sliders, empty, -9, notHFile);  // south west
+        }
+    }
+}
\ No newline at end of file
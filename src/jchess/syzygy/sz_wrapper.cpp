@@ -61,12 +61,12 @@ namespace jchess::syzgy {
 
                 args.white = bstate.color_bbs[WHITE];
                 args.black = bstate.color_bbs[BLACK];
-                args.kings = bstate.piece_bbs[KING | WHITE] | bstate.piece_bbs[KING | BLACK];
-                args.queens = bstate.piece_bbs[QUEEN | WHITE] | bstate.piece_bbs[QUEEN | BLACK];
-                args.rooks = bstate.piece_bbs[ROOK | WHITE] | bstate.piece_bbs[ROOK | BLACK];
-                args.bishops = bstate.piece_bbs[BISHOP | WHITE] | bstate.piece_bbs[BISHOP | BLACK];
-                args.knights = bstate.piece_bbs[KNIGHT | WHITE] | bstate.piece_bbs[KNIGHT | BLACK];
-                args.pawns = bstate.piece_bbs[PAWN | WHITE] | bstate.piece_bbs[PAWN | BLACK];
+                args.kings = bstate.piece_bb(KING, WHITE) | bstate.piece_bb(KING, BLACK);
+                args.queens = bstate.piece_bb(QUEEN, WHITE) | bstate.piece_bb(QUEEN, BLACK);
+                args.rooks = bstate.piece_bb(ROOK, WHITE) | bstate.piece_bb(ROOK, BLACK);
+                args.bishops = bstate.piece_bb(BISHOP, WHITE) | bstate.piece_bb(BISHOP, BLACK);
+                args.knights = bstate.piece_bb(KNIGHT, WHITE) | bstate.piece_bb(KNIGHT, BLACK);
+                args.pawns = bstate.piece_bb(PAWN, WHITE) | bstate.piece_bb(PAWN, BLACK);
                 args.rule50 = gstate.half_moves;
                 args.castling = to_fathom_castling(bstate.castle_right_mask);
                 args.ep = bstate.enp_square.has_value() ? bstate.enp_square.value() : 0;
@@ -75,7 +75,7 @@ namespace jchess::syzgy {
             }
         };
 
-        std::optional<DTZEntry> dtz_entry_from_fathom(unsigned result, Color color) {
+        std::optional<DTZEntry> dtz_entry_from_fathom(unsigned result, BoardState const& state, Color color) {
             if(result == TB_RESULT_FAILED) {
                 return std::nullopt;
             }
@@ -88,10 +88,9 @@ namespace jchess::syzgy {
                 return entry;
             }
             entry.wdl = wdl_from_fathom(TB_GET_WDL(result));
-            entry.move.is_null_move = false;
-            entry.move.source = static_cast<Square>(TB_GET_FROM(result));
-            entry.move.dest = static_cast<Square>(TB_GET_TO(result));
-            entry.move.promotion_type = piece_type_from_fathom(TB_GET_PROMOTES(result), color);
+            auto source = static_cast<Square>(TB_GET_FROM(result));
+            auto dest = static_cast<Square>(TB_GET_TO(result));
+            entry.move = move_from_squares(state, source, dest, piece_type_from_fathom(TB_GET_PROMOTES(result), color));
             entry.dtz = TB_GET_DTZ(result);
             return entry;
         }
@@ -152,6 +151,6 @@ namespace jchess::syzgy {
             nullptr
         );
 
-        return dtz_entry_from_fathom(result, board.get_side_to_move());
+        return dtz_entry_from_fathom(result, board.get_board_state(), board.get_side_to_move());
     }
 }
\ No newline at end of file
@@ -10,7 +10,7 @@ namespace jchess::syzgy {
         bool stalemate = false;
         bool checkmate = false;
         WDL wdl;
-        Move move = "0000";
+        Move move = NULL_MOVE;
         unsigned dtz;
     };
 
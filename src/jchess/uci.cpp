@@ -50,7 +50,7 @@ namespace jchess {
         UciGo args;
         std::unordered_set<std::string> non_searchmoves_subcmds {
             "ponder", "wtime", "btime", "winc", "binc", "movestogo",
-            "depth", "nodes", "mate", "movetime", "infinite"
+            "depth", "nodes", "mate", "movetime", "infinite", "perft"
             };
         auto extract_int = [&token](std::istringstream& tokens){ tokens >> token; return std::stoi(token); };
         while(tokens >> token) {
@@ -87,6 +87,8 @@ namespace jchess {
                 args.mate = extract_int(tokens);
             } else if(token == "movetime") {
                 args.movetime = extract_int(tokens);
+            } else if(token == "perft") {
+                args.perft = extract_int(tokens);
             }
         }
         return args;
@@ -24,7 +24,7 @@ namespace jchess {
         std::vector<std::string> moves;
     };
     struct UciGo {
-        MoveVector search_moves = {};
+        std::vector<std::string> search_moves = {}; // in uci format, only meaningful for the position
         bool ponder = false;
         int wtime = -1;
         int btime = -1;
@@ -36,6 +36,7 @@ namespace jchess {
         int mate = -1;
         int movetime = 0; // milliseconds
         bool infinite = false;
+        int perft = 0; // not part of uci, count the moves to this depth instead of searching
     };
     using UciCommand = std::variant<UciNoArgCmd, UciSetOption, UciPosition, UciGo>;
     std::optional<UciCommand> read_command(std::string const& command);
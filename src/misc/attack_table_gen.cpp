@@ -0,0 +1,59 @@
+#include "jchess/magic_bitboard.h"
+
+#include <fstream>
+#include <iostream>
+
+// the slider and between-square tables are too big to evaluate in the compiler on every rebuild, so this
+// runs the same constexpr initialisers at runtime and writes the results out as a source file for chess_lib.
+//
+// usage: attack_tables <output.cpp>
+
+using namespace jchess;
+
+namespace {
+    template <size_t N>
+    void write_table(std::ostream& out, std::array<Bitboard, N> const& table, std::string const& indent) {
+        out << "{{";
+        for (size_t i = 0; i < N; ++i) {
+            out << (i % 8 == 0 ? "\n" + indent + "    " : " ") << "0x" << std::hex << table[i] << std::dec << "ull" << (i + 1 == N ? "" : ",");
+        }
+        out << "\n" << indent << "}}";
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cerr << "usage: " << argv[0] << " <output.cpp>" << std::endl;
+        return 1;
+    }
+    // static, the rook table is too big for the stack
+    static const RectTable rectangle_between = detail::initialise_rectangle_between();
+    static const detail::BishopAttacks bishop_attacks = detail::initialise_bishop_attacks();
+    static const detail::RookAttacks rook_attacks = detail::initialise_rook_attacks();
+
+    std::ofstream out(argv[1]);
+    if (!out) {
+        std::cerr << "attack_tables: can't open " << argv[1] << std::endl;
+        return 1;
+    }
+    out << "// generated by attack_tables (src/misc/attack_table_gen.cpp), don't edit by hand.\n\n";
+    out << "#include \"jchess/magic_bitboard.h\"\n\n";
+    out << "namespace jchess {\n";
+    out << "    const RectTable RECTANGLE_BETWEEN {{";
+    for (Square square = A1; square < NUM_SQUARES; ++square) {
+        out << "\n        ";
+        write_table(out, rectangle_between[square], "        ");
+        out << (square + 1 == NUM_SQUARES ? "" : ",");
+    }
+    out << "\n    }};\n\n";
+    out << "    namespace detail {\n";
+    out << "        const BishopAttacks BISHOP_ATTACKS ";
+    write_table(out, bishop_attacks, "        ");
+    out << ";\n\n";
+    out << "        const RookAttacks ROOK_ATTACKS ";
+    write_table(out, rook_attacks, "        ");
+    out << ";\n";
+    out << "    }\n";
+    out << "}\n";
+    return out ? 0 : 1;
+}
\ No newline at end of file
@@ -1,19 +1,38 @@
 // https://www.chessprogramming.org/Looking_for_Magics
+//
+// searches for a magic per slider and square, then keeps trying with one index bit fewer for as long as
+// the attempt budget allows, so the packed tables in magic_bitboard.h get smaller. squares are shared
+// between threads, and each square's random stream is seeded from the square so the output doesn't
+// depend on the number of threads.
+//
+// usage: magics [-t threads] [-a attempts per size] [-o header]
+// with no -o the header goes to stdout, src/jchess/magics.h is generated with this.
 
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 typedef unsigned long long uint64;
 
-uint64 random_uint64() {
-    uint64 u1, u2, u3, u4;
-    u1 = (uint64)(random()) & 0xFFFF; u2 = (uint64)(random()) & 0xFFFF;
-    u3 = (uint64)(random()) & 0xFFFF; u4 = (uint64)(random()) & 0xFFFF;
-    return u1 | (u2 << 16) | (u3 << 32) | (u4 << 48);
+typedef struct {
+    uint64 state;
+} Rng;
+
+// xorshift64*, random() has hidden global state and would tie threads together
+uint64 random_uint64(Rng *rng) {
+    rng->state ^= rng->state >> 12;
+    rng->state ^= rng->state << 25;
+    rng->state ^= rng->state >> 27;
+    return rng->state * 0x2545F4914F6CDD1DULL;
 }
 
-uint64 random_uint64_fewbits() {
-    return random_uint64() & random_uint64() & random_uint64();
+uint64 random_uint64_fewbits(Rng *rng) {
+    return random_uint64(rng) & random_uint64(rng) & random_uint64(rng);
 }
 
 int count_1s(uint64 b) {
@@ -110,76 +129,146 @@ uint64 batt(int sq, uint64 block) {
     return result;
 }
 
-
 int transform(uint64 b, uint64 magic, int bits) {
-#if defined(USE_32_BIT_MULTIPLICATIONS)
-    return
-        (unsigned)((int)b*(int)magic ^ (int)(b>>32)*(int)(magic>>32)) >> (32-bits);
-#else
     return (int)((b * magic) >> (64 - bits));
-#endif
 }
 
-uint64 find_magic(int sq, int m, int bishop) {
-    uint64 mask, b[4096], a[4096], used[4096], magic;
-    int i, j, k, n, fail;
-
-    mask = bishop? bmask(sq) : rmask(sq);
-    n = count_1s(mask);
+typedef struct {
+    uint64 blockers[4096];
+    uint64 attacks[4096];
+    uint64 used[4096];
+    int epoch[4096]; // avoids clearing used for every candidate
+    int n;
+} SquareData;
 
-    for(i = 0; i < (1 << n); i++) {
-        b[i] = index_to_uint64(i, n, mask);
-        a[i] = bishop? batt(sq, b[i]) : ratt(sq, b[i]);
+int try_magic(SquareData *data, uint64 magic, int bits, int epoch) {
+    int i, j;
+    for(i = 0; i < (1 << data->n); i++) {
+        j = transform(data->blockers[i], magic, bits);
+        if(data->epoch[j] != epoch) {
+            data->epoch[j] = epoch;
+            data->used[j] = data->attacks[i];
+        }
+        else if(data->used[j] != data->attacks[i]) return 0;
     }
-    for(k = 0; k < 100000000; k++) {
-        magic = random_uint64_fewbits();
+    return 1;
+}
+
+// returns 0 if nothing was found with this many bits
+uint64 find_magic(SquareData *data, uint64 mask, int bits, long attempts, Rng *rng) {
+    uint64 magic;
+    long k;
+    memset(data->epoch, 0, sizeof(data->epoch));
+    for(k = 0; k < attempts; k++) {
+        magic = random_uint64_fewbits(rng);
         if(count_1s((mask * magic) & 0xFF00000000000000ULL) < 6) continue;
-        for(i = 0; i < 4096; i++) used[i] = 0ULL;
-        for(i = 0, fail = 0; !fail && i < (1 << n); i++) {
-            j = transform(b[i], magic, m);
-            if(used[j] == 0ULL) used[j] = a[i];
-            else if(used[j] != a[i]) fail = 1;
-        }
-        if(!fail) return magic;
+        if(try_magic(data, magic, bits, (int)(k + 1))) return magic;
     }
-    printf("***Failed***\n");
     return 0ULL;
 }
 
-int RBits[64] = {
-    12, 11, 11, 11, 11, 11, 11, 12,
-    11, 10, 10, 10, 10, 10, 10, 11,
-    11, 10, 10, 10, 10, 10, 10, 11,
-    11, 10, 10, 10, 10, 10, 10, 11,
-    11, 10, 10, 10, 10, 10, 10, 11,
-    11, 10, 10, 10, 10, 10, 10, 11,
-    11, 10, 10, 10, 10, 10, 10, 11,
-    12, 11, 11, 11, 11, 11, 11, 12
-};
+typedef struct {
+    uint64 magic;
+    int bits;
+} Result;
 
-int BBits[64] = {
-    6, 5, 5, 5, 5, 5, 5, 6,
-    5, 5, 5, 5, 5, 5, 5, 5,
-    5, 5, 7, 7, 7, 7, 5, 5,
-    5, 5, 7, 9, 9, 7, 5, 5,
-    5, 5, 7, 9, 9, 7, 5, 5,
-    5, 5, 7, 7, 7, 7, 5, 5,
-    5, 5, 5, 5, 5, 5, 5, 5,
-    6, 5, 5, 5, 5, 5, 5, 6
-};
+long attempts_per_size = 1000000;
+atomic_int next_job = 0;
+Result results[2][64]; // rook, bishop
 
-int main() {
-    int square;
+void search_square(int sq, int bishop) {
+    SquareData *data = malloc(sizeof(SquareData));
+    uint64 mask = bishop? bmask(sq) : rmask(sq);
+    uint64 magic;
+    int i, bits;
+    Rng rng = {0x9E3779B97F4A7C15ULL ^ ((uint64)(sq + 1) << 8) ^ (uint64)bishop};
 
-    printf("const uint64 RMagic[64] = {\n");
-    for(square = 0; square < 64; square++)
-        printf("  0x%llxULL,\n", find_magic(square, RBits[square], 0));
-    printf("};\n\n");
+    data->n = count_1s(mask);
+    for(i = 0; i < (1 << data->n); i++) {
+        data->blockers[i] = index_to_uint64(i, data->n, mask);
+        data->attacks[i] = bishop? batt(sq, data->blockers[i]) : ratt(sq, data->blockers[i]);
+    }
+    // a magic using one bit per blocker square always exists, so this can't give up
+    bits = data->n;
+    do {
+        magic = find_magic(data, mask, bits, 100000000, &rng);
+    } while(!magic);
+    results[bishop][sq].magic = magic;
+    results[bishop][sq].bits = bits;
+    while(bits > 1) {
+        magic = find_magic(data, mask, bits - 1, attempts_per_size, &rng);
+        if(!magic) break;
+        bits--;
+        results[bishop][sq].magic = magic;
+        results[bishop][sq].bits = bits;
+    }
+    free(data);
+}
 
-    printf("const uint64 BMagic[64] = {\n");
-    for(square = 0; square < 64; square++)
-        printf("  0x%llxULL,\n", find_magic(square, BBits[square], 1));
-    printf("};\n\n");
+void *worker(void *arg) {
+    int job;
+    (void)arg;
+    while((job = atomic_fetch_add(&next_job, 1)) < 128) {
+        search_square(job % 64, job / 64);
+    }
+    return NULL;
+}
 
+void print_table(FILE *out, const char *decl, int bishop, int bits) {
+    int sq;
+    fprintf(out, "    %s[64] = {", decl);
+    for(sq = 0; sq < 64; sq++) {
+        fprintf(out, sq % 8 == 0 ? "\n        " : " ");
+        if(bits) fprintf(out, "%d%s", results[bishop][sq].bits, sq == 63 ? "" : ",");
+        else fprintf(out, "0x%llxULL%s", results[bishop][sq].magic, sq == 63 ? "" : ",");
+    }
+    fprintf(out, "\n    };\n");
+}
+
+int main(int argc, char **argv) {
+    int num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN), i, opt, sq;
+    long table_size[2] = {0, 0};
+    const char *output = NULL;
+    FILE *out = stdout;
+    pthread_t *threads;
+
+    while((opt = getopt(argc, argv, "t:a:o:")) != -1) {
+        switch(opt) {
+            case 't': num_threads = atoi(optarg); break;
+            case 'a': attempts_per_size = atol(optarg); break;
+            case 'o': output = optarg; break;
+            default:
+                fprintf(stderr, "usage: %s [-t threads] [-a attempts per size] [-o header]\n", argv[0]);
+                return 1;
+        }
+    }
+    if(num_threads < 1) num_threads = 1;
+
+    threads = malloc(sizeof(pthread_t) * num_threads);
+    for(i = 0; i < num_threads; i++) pthread_create(&threads[i], NULL, worker, NULL);
+    for(i = 0; i < num_threads; i++) pthread_join(threads[i], NULL);
+    free(threads);
+
+    for(i = 0; i < 2; i++)
+        for(sq = 0; sq < 64; sq++) table_size[i] += 1L << results[i][sq].bits;
+
+    if(output && !(out = fopen(output, "w"))) {
+        perror(output);
+        return 1;
+    }
+    fprintf(out, "#pragma once\n\n");
+    fprintf(out, "// generated by src/misc/magic_finder.c (-a %ld), don't edit by hand.\n", attempts_per_size);
+    fprintf(out, "// rook table: %ld entries, bishop table: %ld entries\n\n", table_size[0], table_size[1]);
+    fprintf(out, "#include <cstdint>\n\nnamespace jchess::detail {\n");
+    print_table(out, "constexpr uint64_t rook_magics", 0, 0);
+    fprintf(out, "\n");
+    print_table(out, "constexpr uint64_t bishop_magics", 1, 0);
+    fprintf(out, "\n");
+    print_table(out, "constexpr int RBits", 0, 1);
+    fprintf(out, "\n");
+    print_table(out, "constexpr int BBits", 1, 1);
+    fprintf(out, "}");
+    if(out != stdout) fclose(out);
+    fprintf(stderr, "rook table: %ld entries, bishop table: %ld entries\n", table_size[0], table_size[1]);
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,39 @@
+#include "jchess/nnue/wrap_nnue.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// labels a file of positions, one FEN per line, with their NNUE evaluation (from the side to move's point of view):
+// nnue_batch_eval ./data/nn-04a843f8932e.nnue positions.txt [threads] > labelled.csv
+int main(int argc, char **argv) {
+    if(argc != 3 && argc != 4) {
+        std::cerr << "usage: nnue_batch_eval <network file> <fen file> [threads]" << std::endl;
+        return 1;
+    }
+    int threads = (argc == 4) ? std::stoi(argv[3]) : 0;
+    try {
+        jchess::nnue_eval::NNUEEvaluator evaluator{argv[1]};
+        std::ifstream fen_file{argv[2]};
+        std::vector<std::string> fens;
+        std::vector<jchess::nnue_eval::PackedPosition> positions;
+        std::string line;
+        while(std::getline(fen_file, line)) {
+            if(!line.empty()) {
+                positions.emplace_back(jchess::FEN{line});
+                fens.push_back(line);
+            }
+        }
+        std::vector<int32_t> evals(positions.size());
+        auto stats = evaluator.nnue_eval_batch(positions, evals, threads);
+        for(size_t i = 0; i < fens.size(); ++i) {
+            std::cout << fens[i] << "," << evals[i] << "\n";
+        }
+        std::cerr << stats.positions << " positions, " << stats.threads << " threads, "
+                  << static_cast<uint64_t>(stats.positions_per_second()) << " positions/sec" << std::endl;
+    } catch(std::runtime_error& err) {
+        std::cerr << err.what() << std::endl;
+        return 1;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#include "jchess/nnue/wrap_nnue.h"
+
+#include <iostream>
+
+// converts a network file to an image the engine can map instead of parsing, run on the host that will use it:
+// nnue_image_gen ./data/nn-04a843f8932e.nnue ./data/nn-04a843f8932e.img
+int main(int argc, char **argv) {
+    if(argc != 3) {
+        std::cerr << "usage: nnue_image_gen <network file> <image file>" << std::endl;
+        return 1;
+    }
+    try {
+        // the image layout doesn't depend on the instruction set
+        jchess::nnue_eval::NNUEEvaluator evaluator{argv[1], jchess::nnue_eval::SimdLevel::GENERIC};
+        evaluator.write_network_image(argv[2]);
+    } catch(std::runtime_error& err) {
+        std::cerr << err.what() << std::endl;
+        return 1;
+    }
+}
\ No newline at end of file
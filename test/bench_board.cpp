@@ -0,0 +1,154 @@
+#include "jchess/board.h"
+#include "jchess/magic_bitboard.h"
+#include "jchess/moves.h"
+#include "jchess/setwise_attacks.h"
+
+#include <iostream>
+#include <chrono>
+#include <vector>
+
+using namespace jchess;
+using namespace std::chrono;
+
+namespace {
+    const std::vector<std::string> bench_fens = {
+        starting_fen,
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    };
+
+    template <typename F>
+    void report(std::string const& name, uint64_t iterations, F&& f) {
+        auto t1 = high_resolution_clock::now();
+        uint64_t checksum = f();
+        auto t2 = high_resolution_clock::now();
+        double ns = duration<double, std::nano>(t2 - t1).count() / iterations;
+        std::cout << name << ": " << ns << " ns/op (" << checksum << ")" << std::endl;
+    }
+}
+
+int main() {
+    constexpr uint64_t rounds = 200000;
+    std::cout << "sizeof(BoardState): " << sizeof(BoardState) << " sizeof(Board): " << sizeof(Board) << std::endl;
+
+    std::vector<BoardState> states(bench_fens.begin(), bench_fens.end());
+    report("copy", rounds * states.size(), [&] {
+        uint64_t checksum = 0;
+        BoardState copy = states[0];
+        for(uint64_t i = 0; i < rounds; ++i) {
+            for(BoardState const& state : states) {
+                copy = state;
+                checksum += copy.all_pieces_bb;
+            }
+        }
+        return checksum;
+    });
+
+    static Board board;
+    uint64_t num_moves = 0;
+    for(std::string const& fen : bench_fens) {
+        MoveVector moves;
+        board.set_position(FEN{fen});
+        board.generate_legal_moves(moves);
+        num_moves += moves.size();
+    }
+    report("make/unmake", rounds / 10 * num_moves, [&] {
+        uint64_t checksum = 0;
+        for(std::string const& fen : bench_fens) {
+            MoveVector moves;
+            board.set_position(FEN{fen});
+            board.generate_legal_moves(moves);
+            for(uint64_t i = 0; i < rounds / 10; ++i) {
+                for(Move const& move : moves) {
+                    board.make_move(move);
+                    checksum += board.get_board_state().all_pieces_bb;
+                    board.unmake_move();
+                }
+            }
+        }
+        return checksum;
+    });
+
+    report("movegen", rounds * bench_fens.size(), [&] {
+        uint64_t checksum = 0;
+        for(std::string const& fen : bench_fens) {
+            board.set_position(FEN{fen});
+            for(uint64_t i = 0; i < rounds; ++i) {
+                MoveVector moves;
+                board.generate_legal_moves(moves);
+                checksum += moves.size();
+            }
+        }
+        return checksum;
+    });
+
+    // occupancies taken from the bench positions so the lookups hit the same table entries a search would.
+    std::vector<Bitboard> occupancies;
+    for(BoardState const& state : states) {
+        occupancies.push_back(state.all_pieces_bb);
+    }
+    SliderBackend original = get_slider_backend();
+    std::cout << "slider backend at startup: " << slider_backend_name(original) << std::endl;
+    for(SliderBackend backend : {SliderBackend::MAGIC, SliderBackend::PEXT}) {
+        if(!slider_backend_available(backend)) {
+            std::cout << "slider attacks (" << slider_backend_name(backend) << "): not available" << std::endl;
+            continue;
+        }
+        set_slider_backend(backend);
+        report("slider attacks (" + std::string(slider_backend_name(backend)) + ")", rounds / 10 * occupancies.size() * NUM_SQUARES * 2, [&] {
+            uint64_t checksum = 0;
+            for(uint64_t i = 0; i < rounds / 10; ++i) {
+                for(Bitboard occupied : occupancies) {
+                    for(Square square = A1; square < NUM_SQUARES; ++square) {
+                        checksum += get_bishop_attacks(square, occupied) ^ get_rook_attacks(square, occupied);
+                    }
+                }
+            }
+            return checksum;
+        });
+    }
+    set_slider_backend(original);
+
+    // every square attacked by one side's sliders, a magic lookup per piece against one set-wise fill.
+    report("slider attack map (magic per piece)", rounds / 10 * states.size() * 2, [&] {
+        uint64_t checksum = 0;
+        for(uint64_t i = 0; i < rounds / 10; ++i) {
+            for(BoardState const& state : states) {
+                for(Color color : {WHITE, BLACK}) {
+                    Bitboard attacked = 0ull, orth = state.orth_sliders(color), diag = state.diag_sliders(color);
+                    Square sq;
+                    while(pop_lsb_square(orth, sq)) {
+                        attacked |= get_rook_moves(sq, 0ull, state.all_pieces_bb);
+                    }
+                    while(pop_lsb_square(diag, sq)) {
+                        attacked |= get_bishop_moves(sq, 0ull, state.all_pieces_bb);
+                    }
+                    checksum += attacked;
+                }
+            }
+        }
+        return checksum;
+    });
+    SetwiseBackend original_setwise = get_setwise_backend();
+    std::cout << "setwise backend at startup: " << setwise_backend_name(original_setwise) << std::endl;
+    for(SetwiseBackend backend : {SetwiseBackend::SCALAR, SetwiseBackend::AVX2}) {
+        if(!setwise_backend_available(backend)) {
+            std::cout << "slider attack map (" << setwise_backend_name(backend) << "): not available" << std::endl;
+            continue;
+        }
+        set_setwise_backend(backend);
+        report("slider attack map (" + std::string(setwise_backend_name(backend)) + ")", rounds / 10 * states.size() * 2, [&] {
+            uint64_t checksum = 0;
+            for(uint64_t i = 0; i < rounds / 10; ++i) {
+                for(BoardState const& state : states) {
+                    for(Color color : {WHITE, BLACK}) {
+                        checksum += get_slider_attacks_setwise(state.orth_sliders(color), state.diag_sliders(color), state.all_pieces_bb);
+                    }
+                }
+            }
+            return checksum;
+        });
+    }
+    set_setwise_backend(original_setwise);
+}
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "jchess/bitboard.h"
 #include "jchess/magic_bitboard.h"
+#include "jchess/setwise_attacks.h"
 
 using namespace jchess;
 
@@ -73,4 +74,77 @@ TEST_CASE("castle right bitboards") {
     REQUIRE(BLACK_QS_BB == bb_from_squares({A8, B8, C8, D8, E8}));
     REQUIRE(WHITE_KS_BB == bb_from_squares({E1, F1, G1, H1}));
     REQUIRE(BLACK_KS_BB == bb_from_squares({E8, F8, G8, H8}));
+}
+
+TEST_CASE("slider backends agree with ray attacks") {
+    SliderBackend original = get_slider_backend();
+    REQUIRE(slider_backend_available(SliderBackend::MAGIC));
+    for(SliderBackend backend : {SliderBackend::MAGIC, SliderBackend::PEXT}) {
+        if(!slider_backend_available(backend)) {
+            REQUIRE_THROWS(set_slider_backend(backend));
+            continue;
+        }
+        set_slider_backend(backend);
+        REQUIRE(get_slider_backend() == backend);
+        for(Square square = A1; square < NUM_SQUARES; ++square) {
+            int bishop_mismatches = 0, rook_mismatches = 0;
+            for(Bitboard blockers : get_subsets_of_mask(detail::BISHOP_BLOCKER_MASKS[square])) {
+                // squares off the mask must not change the lookup
+                Bitboard noisy = blockers | (~detail::BISHOP_BLOCKER_MASKS[square] & 0x8142241818244281ull);
+                bishop_mismatches += get_bishop_attacks(square, noisy) != detail::compute_blocked_bishop_attacks(blockers, square);
+            }
+            for(Bitboard blockers : get_subsets_of_mask(detail::ROOK_BLOCKER_MASKS[square])) {
+                Bitboard noisy = blockers | (~detail::ROOK_BLOCKER_MASKS[square] & 0x8142241818244281ull);
+                rook_mismatches += get_rook_attacks(square, noisy) != detail::compute_blocked_rook_attacks(blockers, square);
+            }
+            REQUIRE(bishop_mismatches == 0);
+            REQUIRE(rook_mismatches == 0);
+        }
+    }
+    set_slider_backend(original);
+}
+
+TEST_CASE("generated attack tables match the constexpr initialisers") {
+    // static, the rook table is too big for the stack
+    static const RectTable rectangle_between = detail::initialise_rectangle_between();
+    static const detail::BishopAttacks bishop_attacks = detail::initialise_bishop_attacks();
+    static const detail::RookAttacks rook_attacks = detail::initialise_rook_attacks();
+    REQUIRE(RECTANGLE_BETWEEN == rectangle_between);
+    REQUIRE(detail::BISHOP_ATTACKS == bishop_attacks);
+    REQUIRE(detail::ROOK_ATTACKS == rook_attacks);
+}
+
+TEST_CASE("setwise slider attacks agree with the magic lookups") {
+    SetwiseBackend original = get_setwise_backend();
+    for(SetwiseBackend backend : {SetwiseBackend::SCALAR, SetwiseBackend::AVX2}) {
+        if(!setwise_backend_available(backend)) {
+            REQUIRE_THROWS(set_setwise_backend(backend));
+            continue;
+        }
+        set_setwise_backend(backend);
+        uint64_t seed = 0x9E3779B97F4A7C15ull;
+        auto next_random = [&seed] {
+            seed ^= seed >> 12;
+            seed ^= seed << 25;
+            seed ^= seed >> 27;
+            return seed * 0x2545F4914F6CDD1Dull;
+        };
+        int mismatches = 0;
+        for(int i = 0; i < 10000; ++i) {
+            Bitboard occupied = next_random() & next_random();
+            Bitboard orth = occupied & next_random() & next_random();
+            Bitboard diag = occupied & next_random() & next_random();
+            Bitboard expected = 0ull;
+            Square sq;
+            for(Bitboard bb = orth; pop_lsb_square(bb, sq);) {
+                expected |= get_rook_attacks(sq, occupied);
+            }
+            for(Bitboard bb = diag; pop_lsb_square(bb, sq);) {
+                expected |= get_bishop_attacks(sq, occupied);
+            }
+            mismatches += get_slider_attacks_setwise(orth, diag, occupied) != expected;
+        }
+        REQUIRE(mismatches == 0);
+    }
+    set_setwise_backend(original);
 }
\ No newline at end of file
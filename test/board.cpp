@@ -1,6 +1,10 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include "jchess/board.h"
+#include "jchess/perft.h"
+
+#include <algorithm>
+#include <bit>
 
 using namespace jchess;
 
@@ -9,13 +13,317 @@ TEST_CASE("Board State FEN ctor") {
     REQUIRE(starting.all_pieces_bb == 0xFFFF00000000FFFF);
     REQUIRE(starting.color_bbs[WHITE] == 0xFFFF);
     REQUIRE(starting.color_bbs[BLACK] == 0xFFFF000000000000);
-    REQUIRE(starting.piece_bbs[B_PAWN] == 0x00FF000000000000);
+    REQUIRE(starting.piece_bb(B_PAWN) == 0x00FF000000000000);
 }
 
 TEST_CASE("Getting next move from Board State") {
     BoardState starting{starting_fen};
-    BoardState pawn_dbl = get_state_after_move(starting, Move("e2e4"));
+    BoardState pawn_dbl = get_state_after_move(starting, move_from_uci(starting, "e2e4"));
     REQUIRE((pawn_dbl.enp_square.has_value() && pawn_dbl.enp_square.value() == E3));
-    BoardState qs_rook = get_state_after_move(starting, Move("a1a3"));
+    BoardState qs_rook = get_state_after_move(starting, move_from_uci(starting, "a1a3"));
     REQUIRE((qs_rook.castle_right_mask & WHITE_QS) == 0);
+}
+
+TEST_CASE("Dirty pieces of a move") {
+    BoardState castle{"4k3/8/8/8/8/8/8/4K2R w K - 0 1"};
+    DirtyPieces dirty = get_dirty_pieces(castle, move_from_uci(castle, "e1g1"));
+    REQUIRE(dirty.num == 2);
+    REQUIRE((dirty.pieces[0].piece == W_KING && dirty.pieces[0].from == E1 && dirty.pieces[0].to == G1));
+    REQUIRE((dirty.pieces[1].piece == W_ROOK && dirty.pieces[1].from == H1 && dirty.pieces[1].to == F1));
+
+    BoardState enp{"4k3/8/8/3Pp3/8/8/8/4K3 w - e6 0 1"};
+    dirty = get_dirty_pieces(enp, move_from_uci(enp, "d5e6"));
+    REQUIRE(dirty.num == 2);
+    REQUIRE((dirty.pieces[0].piece == B_PAWN && dirty.pieces[0].from == E5 && dirty.pieces[0].to == NUM_SQUARES));
+
+    BoardState promote{"1r2k3/P7/8/8/8/8/8/4K3 w - - 0 1"};
+    dirty = get_dirty_pieces(promote, move_from_uci(promote, "a7b8n"));
+    REQUIRE(dirty.num == 3);
+    REQUIRE((dirty.pieces[0].piece == B_ROOK && dirty.pieces[0].from == B8));
+    REQUIRE((dirty.pieces[1].piece == W_PAWN && dirty.pieces[1].to == NUM_SQUARES));
+    REQUIRE((dirty.pieces[2].piece == W_KNIGHT && dirty.pieces[2].from == NUM_SQUARES && dirty.pieces[2].to == B8));
+}
+
+TEST_CASE("Move flags from uci") {
+    BoardState castle{"r3k3/8/8/8/8/8/8/4K2R w K - 0 1"};
+    REQUIRE(move_from_uci(castle, "e1g1").flag() == CASTLING);
+    REQUIRE(move_from_uci(castle, "e1f1").flag() == NORMAL_MOVE);
+    REQUIRE(move_from_uci(castle, "0000").is_null_move());
+    BoardState enp{"4k3/8/8/3Pp3/8/8/8/4K3 w - e6 0 1"};
+    REQUIRE(move_from_uci(enp, "d5e6").flag() == EN_PASSANT);
+    REQUIRE(move_from_uci(enp, "d5d6").flag() == NORMAL_MOVE);
+    BoardState promote{"1r2k3/P7/8/8/8/8/8/4K3 w - - 0 1"};
+    Move promotion = move_from_uci(promote, "a7b8n");
+    REQUIRE(promotion.flag() == PROMOTION);
+    REQUIRE(promotion.promotion_type() == KNIGHT);
+    REQUIRE(move_to_string(promotion) == "a7b8n");
+    REQUIRE_THROWS(move_from_uci(promote, "a7"));
+}
+
+TEST_CASE("Unmaking a move restores the position") {
+    // castling both ways, en passant and promotions with capture all possible from here.
+    std::string kiwipete = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+    static Board board;
+    board.set_position(FEN{kiwipete});
+    MoveVector moves;
+    board.generate_legal_moves(moves);
+    for(Move const& move : moves) {
+        BoardState before = board.get_board_state();
+        GameState game_before = board.get_game_state();
+        MoveVector replies;
+        board.make_move(move);
+        board.generate_legal_moves(replies);
+        for(Move const& reply : replies) {
+            BoardState middle = board.get_board_state();
+            board.make_move(reply);
+            board.unmake_move();
+            REQUIRE(board.get_board_state() == middle);
+            REQUIRE(board.get_board_state().castle_right_mask == middle.castle_right_mask);
+        }
+        board.unmake_move();
+        BoardState const& after = board.get_board_state();
+        REQUIRE(after == before);
+        REQUIRE(after.pieces == before.pieces);
+        REQUIRE(after.castle_right_mask == before.castle_right_mask);
+        REQUIRE(after.pawn_key == before.pawn_key);
+        REQUIRE(after.material_key == before.material_key);
+        REQUIRE((after.psqt.mg == before.psqt.mg && after.psqt.eg == before.psqt.eg && after.phase == before.phase));
+        REQUIRE((after.king_sq[WHITE] == before.king_sq[WHITE] && after.king_sq[BLACK] == before.king_sq[BLACK]));
+        REQUIRE(board.get_game_state() == game_before);
+    }
+    REQUIRE(board.get_ply() == 0);
+}
+
+namespace {
+    uint64_t count_legal_moves(Board& board, int depth) {
+        MoveVector moves;
+        board.generate_legal_moves(moves);
+        if(depth == 1) {
+            return moves.size();
+        }
+        uint64_t nodes = 0;
+        for(Move const& move : moves) {
+            board.make_move(move);
+            nodes += count_legal_moves(board, depth - 1);
+            board.unmake_move();
+        }
+        return nodes;
+    }
+
+    std::vector<uint16_t> sorted_raw(MoveVector const& moves) {
+        std::vector<uint16_t> raw;
+        for(Move const& move : moves) {
+            raw.push_back(move.raw());
+        }
+        std::sort(raw.begin(), raw.end());
+        return raw;
+    }
+
+    std::vector<uint16_t> generate_sorted(Board& board, GenType type) {
+        MoveVector moves;
+        board.generate_legal_moves(moves, type);
+        return sorted_raw(moves);
+    }
+
+    // counts the positions where a generation type didn't give the subset of the legal moves it should.
+    int count_gen_type_mismatches(Board& board, int depth) {
+        MoveVector moves;
+        board.generate_legal_moves(moves);
+        std::vector<uint16_t> all, captures, quiets, quiet_checks;
+        for(Move const& move : moves) {
+            bool capture = board.get_board_state().pieces[move.dest()] != NO_PIECE || move.flag() == EN_PASSANT;
+            all.push_back(move.raw());
+            (capture ? captures : quiets).push_back(move.raw());
+            if(!capture && move.flag() == NORMAL_MOVE && !board.in_check()) {
+                board.make_move(move);
+                if(board.in_check()) {
+                    quiet_checks.push_back(move.raw());
+                }
+                board.unmake_move();
+            }
+        }
+        for(auto* expected : {&all, &captures, &quiets, &quiet_checks}) {
+            std::sort(expected->begin(), expected->end());
+        }
+        int mismatches = 0;
+        mismatches += generate_sorted(board, GenType::ALL) != all;
+        mismatches += generate_sorted(board, GenType::CAPTURES) != captures;
+        mismatches += generate_sorted(board, GenType::QUIETS) != quiets;
+        if(board.in_check()) {
+            mismatches += generate_sorted(board, GenType::EVASIONS) != all;
+        } else {
+            mismatches += generate_sorted(board, GenType::QUIET_CHECKS) != quiet_checks;
+        }
+        if(depth > 1) {
+            for(Move const& move : moves) {
+                board.make_move(move);
+                mismatches += count_gen_type_mismatches(board, depth - 1);
+                board.unmake_move();
+            }
+        }
+        return mismatches;
+    }
+
+    // counts the positions where the pseudo-legal moves that pass is_legal aren't the legal moves, where
+    // is_pseudo_legal and is_legal together don't pick out exactly the legal moves from every possible move,
+    // or where is_pseudo_legal accepts a move the pseudo-legal generator wouldn't give.
+    int count_pseudo_legal_mismatches(Board& board, int depth) {
+        MoveVector legal, pseudo, filtered;
+        board.generate_legal_moves(legal);
+        board.generate_pseudo_legal_moves(pseudo);
+        int mismatches = 0;
+        for(Move const& move : pseudo) {
+            mismatches += !board.is_pseudo_legal(move);
+            if(board.is_legal(move)) {
+                filtered.push_back(move);
+            }
+        }
+        std::vector<uint16_t> expected = sorted_raw(legal), generated = sorted_raw(pseudo);
+        mismatches += sorted_raw(filtered) != expected;
+        for(uint32_t raw = 0; raw <= UINT16_MAX; ++raw) {
+            Move move = std::bit_cast<Move>(static_cast<uint16_t>(raw));
+            bool pseudo_legal = board.is_pseudo_legal(move);
+            mismatches += pseudo_legal && !std::binary_search(generated.begin(), generated.end(), move.raw());
+            mismatches += (pseudo_legal && board.is_legal(move)) != std::binary_search(expected.begin(), expected.end(), move.raw());
+        }
+        if(depth > 1) {
+            for(Move const& move : legal) {
+                board.make_move(move);
+                mismatches += count_pseudo_legal_mismatches(board, depth - 1);
+                board.unmake_move();
+            }
+        }
+        return mismatches;
+    }
+}
+
+TEST_CASE("Legal moves with checks and pins") {
+    static Board board;
+    // known perft results: https://www.chessprogramming.org/Perft_Results
+    board.set_position(FEN{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"});
+    REQUIRE(count_legal_moves(board, 3) == 97862);
+    board.set_position(FEN{"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"});
+    REQUIRE(count_legal_moves(board, 4) == 43238);
+    board.set_position(FEN{"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1"});
+    REQUIRE(count_legal_moves(board, 3) == 9467);
+    // taking en passant would leave both pawns off the king's rank.
+    board.set_position(FEN{"8/8/8/K1pP3r/8/8/8/7k w - c6 0 2"});
+    REQUIRE(count_legal_moves(board, 1) == 5);
+    // the pinned bishop can only move along the pin.
+    board.set_position(FEN{"4k3/8/8/8/8/2b5/3B4/4K3 w - - 0 1"});
+    MoveVector moves;
+    board.generate_legal_moves(moves);
+    REQUIRE(std::count_if(moves.begin(), moves.end(), [](Move move) { return move.source() == D2; }) == 1);
+}
+
+TEST_CASE("Attack info follows the position") {
+    static Board board;
+    board.set_position(FEN{"4k3/8/8/8/8/8/8/R3K3 w - - 0 1"});
+    REQUIRE(!board.in_check());
+    REQUIRE(board.gives_check(move_from_uci(board, "a1a8")));
+    REQUIRE(!board.gives_check(move_from_uci(board, "a1a7")));
+    board.make_move(move_from_uci(board, "a1a8"));
+    REQUIRE(board.in_check());
+    REQUIRE(board.get_attack_info().checkers == bb_from_square(A8));
+    board.unmake_move();
+    REQUIRE(!board.in_check());
+    REQUIRE(board.get_attack_info().checkers == 0ull);
+
+    board.set_position(FEN{"4k3/4r3/8/8/8/8/4N3/4K3 w - - 0 1"});
+    REQUIRE(board.get_attack_info().pinned == bb_from_square(E2));
+}
+
+TEST_CASE("Generation types split the legal moves") {
+    static Board board;
+    for(std::string fen : {
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        // discovered checks from a knight on the file, a pawn on the diagonal and a king on the rank.
+        "4k3/8/8/8/4N3/8/8/4R1K1 w - - 0 1",
+        "7k/8/8/8/3P4/8/1B6/6K1 w - - 0 1",
+        "8/8/8/R2K3k/8/8/8/8 w - - 0 1",
+    }) {
+        board.set_position(FEN{fen});
+        REQUIRE(count_gen_type_mismatches(board, 2) == 0);
+    }
+}
+
+TEST_CASE("Pseudo-legal moves filtered by legality") {
+    static Board board;
+    for(std::string fen : {
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        // en passant off the king's rank, and castling through an attacked square.
+        "8/8/8/K1pP3r/8/8/8/7k w - c6 0 2",
+        "r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1",
+        "4k3/8/8/8/8/8/5r2/R3K2R w KQ - 0 1",
+        // double check, only the king can move.
+        "4k3/8/8/8/1b6/8/4r3/R3K2N w - - 0 1",
+        // the enemy king covering squares next to our king, on its castling path and on the castling square.
+        "8/8/8/8/8/4k3/8/4K3 w - - 0 1",
+        "8/8/8/8/8/8/6k1/4K2R w K - 0 1",
+        "8/8/8/8/8/8/1k6/R3K3 w Q - 0 1",
+    }) {
+        board.set_position(FEN{fen});
+        REQUIRE(count_pseudo_legal_mismatches(board, 2) == 0);
+    }
+}
+
+TEST_CASE("Threaded perft divide") {
+    Board board{FEN{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"}};
+    REQUIRE(perft(board, 0) == 1);
+    REQUIRE(perft(board, 3) == 97862);
+    for(int num_threads : {1, 3}) {
+        for(auto [depth, expected] : {std::pair{1, 48ull}, {2, 2039ull}, {3, 97862ull}}) {
+            PerftResult result = perft_divide(board, depth, num_threads);
+            REQUIRE(result.nodes == expected);
+            REQUIRE(result.divide.size() == 48);
+            uint64_t total = 0;
+            for(auto const& [move, nodes] : result.divide) {
+                board.make_move(move);
+                REQUIRE(nodes == (depth == 1 ? 1 : count_legal_moves(board, depth - 1)));
+                board.unmake_move();
+                total += nodes;
+            }
+            REQUIRE(total == expected);
+        }
+    }
+}
+
+TEST_CASE("Zobrist key follows the position") {
+    Board board;
+    uint64_t start_key = board.get_key();
+    for(std::string move : {"g1f3", "g8f6", "f3g1"}) {
+        board.make_move(move_from_uci(board, move));
+        REQUIRE(board.get_key() != start_key);
+    }
+    board.make_move(move_from_uci(board, "f6g8"));
+    REQUIRE(board.get_key() == start_key); // the move counters aren't part of it
+    board.unmake_move();
+    board.unmake_move();
+    REQUIRE(board.get_key() == Board{FEN{"rnbqkb1r/pppppppp/5n2/8/8/5N2/PPPPPPPP/RNBQKB1R w KQkq - 2 2"}}.get_key());
+
+    board.set_position(FEN{starting_fen});
+    board.make_move(move_from_uci(board, "e2e4"));
+    REQUIRE(board.get_key() == Board{FEN{"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1"}}.get_key());
+    REQUIRE(board.get_key() != Board{FEN{"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1"}}.get_key());
+    REQUIRE(board.get_key() != Board{FEN{"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR w KQkq e3 0 1"}}.get_key());
+    REQUIRE(board.get_key() != Board{FEN{"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b Kkq e3 0 1"}}.get_key());
+}
+
+TEST_CASE("Perft table keeps counts exact") {
+    Board board{FEN{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"}};
+    // small enough that entries get replaced.
+    PerftTable table{1};
+    for(int num_threads : {1, 3}) {
+        table.clear();
+        PerftResult first = perft_divide(board, 4, num_threads, &table);
+        REQUIRE(first.nodes == 4085603);
+        PerftResult second = perft_divide(board, 4, num_threads, &table);
+        REQUIRE(second.nodes == 4085603);
+        REQUIRE(second.table_hits > first.table_hits);
+        REQUIRE(second.divide == first.divide);
+    }
 }
\ No newline at end of file
@@ -53,12 +53,17 @@ TEST_CASE("Castle Bits") {
 }
 
 TEST_CASE("Moves") {
-    REQUIRE(Move("0000").is_null_move == true);
-    Move move {"e4e6q"};
-    REQUIRE(move.source == E4);
-    REQUIRE(move.dest == E6);
-    REQUIRE(move.promotion_type == QUEEN);
-    REQUIRE(!Move("e2e3").promotion_type.has_value());
+    REQUIRE(NULL_MOVE.is_null_move() == true);
+    REQUIRE(move_to_string(NULL_MOVE) == "0000");
+    Move move {E4, E6, QUEEN};
+    REQUIRE(move.source() == E4);
+    REQUIRE(move.dest() == E6);
+    REQUIRE(move.promotion_type() == QUEEN);
+    REQUIRE(move.flag() == PROMOTION);
+    REQUIRE(move_to_string(move) == "e4e6q");
+    REQUIRE(!Move(E2, E3).promotion_type().has_value());
+    REQUIRE(Move(E1, G1, CASTLING).flag() == CASTLING);
+    REQUIRE(sizeof(Move) == 2);
 }
 
 TEST_CASE("FEN parsing") {
@@ -0,0 +1,149 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "jchess/eval.h"
+#include "jchess/material.h"
+#include "jchess/pawns.h"
+
+using namespace jchess;
+
+namespace {
+    // boards are too big to have many of them on the stack at once.
+    Score eval_fen(std::string const& fen) {
+        static Board board;
+        board.set_position(FEN{fen});
+        return eval(board);
+    }
+}
+
+TEST_CASE("pawn key updated incrementally") {
+    Board board{starting_fen};
+    for(std::string move : {"e2e4", "d7d5", "e4d5", "g8f6", "g1f3"}) {
+        board.make_move(move_from_uci(board, move));
+    }
+    BoardState from_fen{"rnbqkb1r/ppp1pppp/5n2/3P4/8/5N2/PPPP1PPP/RNBQKB1R b KQkq - 1 3"};
+    REQUIRE(board.get_board_state().pawn_key == from_fen.pawn_key);
+    board.unmake_move();
+    board.unmake_move();
+    board.unmake_move();
+    REQUIRE(board.get_board_state().pawn_key != from_fen.pawn_key);
+}
+
+TEST_CASE("piece square score and phase updated incrementally") {
+    BoardState start{starting_fen};
+    REQUIRE(start.psqt.mg == 0);
+    REQUIRE(start.psqt.eg == 0);
+    REQUIRE(start.phase == detail::MAX_PHASE);
+
+    // capture, then capture-promotion
+    Board board{"r3k3/1P6/8/8/8/8/8/4K2R w K - 0 1"};
+    board.make_move(move_from_uci(board, "b7a8q"));
+    BoardState from_fen{"Q3k3/8/8/8/8/8/8/4K2R b K - 0 1"};
+    REQUIRE(board.get_board_state().psqt.mg == from_fen.psqt.mg);
+    REQUIRE(board.get_board_state().psqt.eg == from_fen.psqt.eg);
+    REQUIRE(board.get_board_state().phase == from_fen.phase);
+    REQUIRE(from_fen.phase == 6);
+    board.unmake_move();
+    REQUIRE(board.get_board_state().psqt.mg == BoardState{"r3k3/1P6/8/8/8/8/8/4K2R w K - 0 1"}.psqt.mg);
+
+    // castling
+    board.set_position(FEN{"4k3/8/8/8/8/8/8/4K2R w K - 0 1"});
+    board.make_move(move_from_uci(board, "e1g1"));
+    REQUIRE(board.get_board_state().psqt.eg == BoardState{"4k3/8/8/8/8/8/8/5RK1 b - - 1 1"}.psqt.eg);
+}
+
+TEST_CASE("pawn structure terms") {
+    // white: a2 isolated, c4 and c5 doubled, c5 passed as black has no b, c or d pawns. black: h7 passed.
+    BoardState state{"4k3/7p/8/2P5/2P5/8/P7/4K3 w - - 0 1"};
+    PawnEntry entry;
+    compute_pawn_entry(entry, state);
+    REQUIRE(entry.passed_pawns[WHITE] == bb_from_squares({A2, C5}));
+    REQUIRE(entry.passed_pawns[BLACK] == bb_from_square(H7));
+    REQUIRE(entry.pawn_attacks[WHITE] == bb_from_squares({B3, B5, D5, B6, D6}));
+    REQUIRE(entry.pawn_attack_spans[BLACK] == bb_from_squares({G1, G2, G3, G4, G5, G6}));
+
+    PawnEntry doubled, connected;
+    compute_pawn_entry(doubled, BoardState{"4k3/8/8/8/2P5/2P5/8/4K3 w - - 0 1"});
+    compute_pawn_entry(connected, BoardState{"4k3/8/8/8/2P5/3P4/8/4K3 w - - 0 1"});
+    REQUIRE(doubled.score[WHITE].mg < connected.score[WHITE].mg);
+    REQUIRE(doubled.score[WHITE].eg < connected.score[WHITE].eg);
+}
+
+TEST_CASE("pawn hash table") {
+    PawnHashTable table{1 << 4};
+    BoardState state{starting_fen};
+    PawnEntry computed;
+    compute_pawn_entry(computed, state);
+    PawnEntry& first = table.probe(state);
+    PawnEntry& second = table.probe(state);
+    REQUIRE(&first == &second);
+    REQUIRE(table.num_misses() == 1);
+    REQUIRE(table.num_hits() == 1);
+    REQUIRE(first.passed_pawns[WHITE] == computed.passed_pawns[WHITE]);
+    REQUIRE(first.score[BLACK].mg == computed.score[BLACK].mg);
+}
+
+TEST_CASE("eval is symmetric") {
+    Board white{"r1bqk2r/pp3ppp/2n1pn2/2pp4/1bPP4/2N1PN2/PP3PPP/R1BQKB1R w KQkq - 0 6"};
+    Board black{"r1bqkb1r/pp3ppp/2n1pn2/1Bpp4/2PP4/2N1PN2/PP3PPP/R1BQK2R b KQkq - 0 6"};
+    PawnHashTable table;
+    REQUIRE(eval(white) == eval(black));
+    REQUIRE(eval(white, table) == eval(white));
+    REQUIRE(eval(black, table) == eval(black));
+}
+
+TEST_CASE("material key updated incrementally") {
+    Board board{"4k3/8/8/3p4/4N3/8/8/4K3 b - - 0 1"};
+    board.make_move(move_from_uci(board, "d5e4"));
+    BoardState from_fen{"4k3/8/8/8/4p3/8/8/4K3 w - - 0 2"};
+    REQUIRE(board.get_board_state().material_key == from_fen.material_key);
+    // only the piece counts matter, not where the pieces are
+    REQUIRE(BoardState{"4k3/8/8/8/8/8/4p3/K7 w - - 0 1"}.material_key == from_fen.material_key);
+    board.unmake_move();
+    REQUIRE(board.get_board_state().material_key != from_fen.material_key);
+}
+
+TEST_CASE("insufficient material") {
+    for(std::string fen : {"4k3/8/8/8/8/8/8/4K3 w - - 0 1", "4k3/8/8/8/8/8/8/4KN2 w - - 0 1", "4kb2/8/8/8/8/8/8/4K3 w - - 0 1"}) {
+        MaterialEntry entry;
+        compute_material_entry(entry, BoardState{fen});
+        REQUIRE(entry.insufficient_material);
+        REQUIRE(eval_fen(fen) == 0);
+    }
+    for(std::string fen : {"4k3/8/8/8/8/8/8/4KR2 w - - 0 1", "4k3/8/8/8/8/8/4P3/4K3 w - - 0 1", "4k3/8/8/8/8/8/8/3BKN2 w - - 0 1"}) {
+        MaterialEntry entry;
+        compute_material_entry(entry, BoardState{fen});
+        REQUIRE(!entry.insufficient_material);
+    }
+}
+
+TEST_CASE("endgame recognisers") {
+    // KRK, the stronger side is winning whoever is to move, more so with the weak king on the edge.
+    Score centre = eval_fen("8/8/8/4k3/8/4K3/8/R7 w - - 0 1");
+    Score edge = eval_fen("4k3/8/4K3/8/8/8/8/R7 w - - 0 1");
+    REQUIRE(centre > 5000);
+    REQUIRE(edge > centre);
+    REQUIRE(eval_fen("8/8/8/4k3/8/8/8/R3K3 b - - 0 1") < -5000);
+    // KNNK can't be forced
+    REQUIRE(eval_fen("4k3/8/8/8/8/8/8/1N2K1N1 w - - 0 1") == 0);
+    // KPK, the black king is outside the square of the pawn
+    REQUIRE(eval_fen("8/8/8/5k2/P7/8/8/4K3 w - - 0 1") > 5000);
+    REQUIRE(eval_fen("8/8/8/5k2/P7/8/8/4K3 b - - 0 1") > -5000);
+    // KPK, the black king sits in front of a rook pawn
+    REQUIRE(eval_fen("k7/8/8/8/P7/8/8/4K3 w - - 0 1") == 0);
+    // KRKR, the regular eval is scaled down to near a draw
+    MaterialEntry entry;
+    compute_material_entry(entry, BoardState{"r3k3/8/8/8/8/8/8/R3K3 w - - 0 1"});
+    REQUIRE(!entry.has_endgame_eval());
+    REQUIRE(entry.scale_factor(BoardState{"r3k3/8/8/8/8/8/8/R3K3 w - - 0 1"}, WHITE) < detail::SCALE_NORMAL);
+}
+
+TEST_CASE("material hash table") {
+    MaterialHashTable table{1 << 4};
+    PawnHashTable pawn_table;
+    Board board{"r1bqk2r/pp3ppp/2n1pn2/2pp4/1bPP4/2N1PN2/PP3PPP/R1BQKB1R w KQkq - 0 6"};
+    MaterialEntry& first = table.probe(board.get_board_state());
+    MaterialEntry& second = table.probe(board.get_board_state());
+    REQUIRE(&first == &second);
+    REQUIRE(first.key == board.get_board_state().material_key);
+    REQUIRE(eval(board, pawn_table, table) == eval(board));
+}
\ No newline at end of file
@@ -3,6 +3,10 @@
 #include "jchess/nnue/wrap_nnue.h"
 #include "jchess/search.h"
 
+#include <filesystem>
+#include <fstream>
+#include <random>
+
 using namespace jchess::nnue_eval;
 
 TEST_CASE("sane evaluation fen") {
@@ -29,6 +33,218 @@ TEST_CASE("sane evaluation board") {
     REQUIRE(score_bal < score_w);
 }
 
+TEST_CASE("incremental evaluation matches a full refresh") {
+    using namespace jchess;
+    std::string kiwipete = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+    NNUEEvaluator evaluator{"../data/nn-04a843f8932e.nnue"};
+    // boards are too big to have several on the stack.
+    static Board board;
+    board.set_position(FEN{kiwipete});
+    for(int step = 0; step < 60; ++step) {
+        MoveVector moves;
+        board.generate_legal_moves(moves);
+        if(moves.empty() || step % 7 == 6) {
+            board.unmake_move();
+        } else {
+            board.make_move(moves[(step * 13) % moves.size()]);
+        }
+        REQUIRE(evaluator.nnue_eval_board(board) == evaluator.nnue_eval_board_full(board));
+    }
+}
+
+TEST_CASE("king moves refresh from the cache") {
+    using namespace jchess;
+    std::string endgame = "8/2k5/3p4/p2P1p2/P2P1P2/8/3K4/8 w - - 0 1";
+    NNUEEvaluator evaluator{"../data/nn-04a843f8932e.nnue"};
+    static Board board;
+    board.set_position(FEN{endgame});
+    // the kings walk away and back again, so later refreshes find their square in the cache: black back on c7
+    // twice and on b6 once, white back on e3. the other king moves go to squares not seen yet.
+    for(std::string move : {"d2e3", "c7b6", "e3f3", "b6c7", "f3e3", "c7b6", "e3d2", "b6c7", "d2c2", "c7b7"}) {
+        board.make_move(move_from_uci(board, move));
+        REQUIRE(evaluator.nnue_eval_board(board) == evaluator.nnue_eval_board_full(board));
+    }
+    REQUIRE(evaluator.get_refresh_table_hits() == 4);
+}
+
+TEST_CASE("every available instruction set gives the same evaluation") {
+    using namespace jchess;
+    std::vector<std::string> fens = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2k5/3p4/p2P1p2/P2P1P2/8/3K4/8 w - - 0 1",
+        "r1bqkb1r/pppn1ppp/4p3/3n4/2BP1B2/2N1PN2/PP3PPP/R2QK2R b KQkq - 0 1"
+    };
+    NNUEEvaluator reference{"../data/nn-04a843f8932e.nnue", SimdLevel::GENERIC};
+    REQUIRE(simd_level_available(best_simd_level()));
+    for(SimdLevel level : {SimdLevel::SSE2, SimdLevel::SSSE3, SimdLevel::AVX2, SimdLevel::AVX512, SimdLevel::NEON}) {
+        if(!simd_level_available(level)) {
+            REQUIRE_THROWS(NNUEEvaluator{"../data/nn-04a843f8932e.nnue", level});
+            continue;
+        }
+        NNUEEvaluator simd{"../data/nn-04a843f8932e.nnue", level};
+        REQUIRE(simd.get_simd_level() == level);
+        for(std::string const& fen : fens) {
+            REQUIRE(simd.nnue_eval_fen(fen) == reference.nnue_eval_fen(fen));
+        }
+    }
+}
+
+TEST_CASE("sparse and dense hidden layer kernels agree") {
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<int> weight_dist{-128, 127};
+    std::uniform_int_distribution<int> bias_dist{-10000, 10000};
+    // what the clamp in front of the layer can give
+    std::uniform_int_distribution<int> input_dist{1, 127};
+    std::uniform_real_distribution<double> density_dist{0.0, 1.0};
+    std::vector<int8_t> weights(HIDDEN_LAYER_INPUTS * HIDDEN_LAYER_OUTPUTS);
+    std::vector<int32_t> biases(HIDDEN_LAYER_OUTPUTS);
+    for(int8_t& weight : weights) {
+        weight = static_cast<int8_t>(weight_dist(rng));
+    }
+    for(int32_t& bias : biases) {
+        bias = bias_dist(rng);
+    }
+    // all zero, fully dense, then random densities, which leave some chunks of 4 inputs partly zero.
+    std::vector<double> densities = {0.0, 1.0};
+    for(int i = 0; i < 20; ++i) {
+        densities.push_back(density_dist(rng));
+    }
+    for(SimdLevel level : {SimdLevel::GENERIC, SimdLevel::SSE2, SimdLevel::SSSE3, SimdLevel::AVX2, SimdLevel::AVX512, SimdLevel::NEON}) {
+        if(!simd_level_available(level)) {
+            REQUIRE_THROWS(hidden_layer_products(level, std::vector<uint8_t>(HIDDEN_LAYER_INPUTS), weights, biases));
+            continue;
+        }
+        for(double density : densities) {
+            std::vector<uint8_t> input(HIDDEN_LAYER_INPUTS);
+            for(uint8_t& value : input) {
+                value = (density_dist(rng) < density) ? static_cast<uint8_t>(input_dist(rng)) : 0;
+            }
+            std::vector<int32_t> expected(biases);
+            for(size_t output = 0; output < HIDDEN_LAYER_OUTPUTS; ++output) {
+                for(size_t i = 0; i < HIDDEN_LAYER_INPUTS; ++i) {
+                    expected[output] += input[i] * weights[output * HIDDEN_LAYER_INPUTS + i];
+                }
+            }
+            HiddenLayerProducts products = hidden_layer_products(level, input, weights, biases);
+            REQUIRE(products.dense == expected);
+            REQUIRE(products.sparse == expected);
+        }
+    }
+}
+
+TEST_CASE("a network image is mapped and evaluates the same") {
+    using namespace jchess;
+    std::string image_file = "./nnue_image_test.img";
+    std::vector<std::string> fens = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2k5/3p4/p2P1p2/P2P1P2/8/3K4/8 w - - 0 1"
+    };
+    NNUEEvaluator reference{"../data/nn-04a843f8932e.nnue", SimdLevel::GENERIC};
+    REQUIRE_FALSE(reference.is_network_mapped());
+    reference.write_network_image(image_file);
+    // the image layout is the same for every instruction set
+    for(SimdLevel level : {SimdLevel::GENERIC, best_simd_level()}) {
+        NNUEEvaluator mapped{image_file, level};
+        REQUIRE(mapped.is_network_mapped());
+        for(std::string const& fen : fens) {
+            REQUIRE(mapped.nnue_eval_fen(fen) == reference.nnue_eval_fen(fen));
+        }
+    }
+    std::filesystem::remove(image_file);
+}
+
+TEST_CASE("batch evaluation matches single evaluations") {
+    using namespace jchess;
+    std::string kiwipete = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+    NNUEEvaluator evaluator{"../data/nn-04a843f8932e.nnue"};
+    static Board board;
+    board.set_position(FEN{kiwipete});
+    // a random walk, so many positions share king squares and only differ by a few pieces.
+    std::vector<PackedPosition> positions;
+    std::vector<int32_t> expected;
+    for(int step = 0; step < 80; ++step) {
+        MoveVector moves;
+        board.generate_legal_moves(moves);
+        if(moves.empty() || step % 5 == 4) {
+            board.unmake_move();
+        } else {
+            board.make_move(moves[(step * 17) % moves.size()]);
+        }
+        positions.emplace_back(board);
+        expected.push_back(evaluator.nnue_eval_board(board));
+    }
+    for(int threads : {1, 3}) {
+        std::vector<int32_t> evals(positions.size());
+        BatchStats stats = evaluator.nnue_eval_batch(positions, evals, threads);
+        REQUIRE(stats.positions == positions.size());
+        REQUIRE(stats.threads == threads);
+        REQUIRE(evals == expected);
+    }
+    std::vector<int32_t> too_few(positions.size() - 1);
+    REQUIRE_THROWS(evaluator.nnue_eval_batch(positions, too_few));
+}
+
+namespace {
+    // a network file for the 128 wide architecture with random parameters, there's no trained one in the repo.
+    void write_random_small_network(std::string const& file_name) {
+        std::ofstream file{file_name, std::ios::binary};
+        std::mt19937 rng{1234};
+        auto write = [&file](auto value) {
+            file.write(reinterpret_cast<char const*>(&value), sizeof(value));
+        };
+        auto write_random = [&](auto type, size_t count, int low, int high) {
+            std::uniform_int_distribution<int> dist{low, high};
+            for(size_t i = 0; i < count; ++i) {
+                write(static_cast<decltype(type)>(dist(rng)));
+            }
+        };
+        std::string description = "random halfkp_128x2-32-32";
+        write(uint32_t{0x7AF32F16u});
+        write(uint32_t{0x3E5AA58Eu});
+        write(static_cast<uint32_t>(description.size()));
+        file.write(description.data(), description.size());
+        write(uint32_t{0});
+        write_random(int16_t{}, 128, 0, 64);
+        write_random(int16_t{}, 64 * (10 * 64 + 1) * 128, -16, 16);
+        write(uint32_t{0});
+        write_random(int32_t{}, 32, -1000, 1000);
+        write_random(int8_t{}, 32 * 256, -32, 32);
+        write_random(int32_t{}, 32, -1000, 1000);
+        write_random(int8_t{}, 32 * 32, -32, 32);
+        write_random(int32_t{}, 1, -1000, 1000);
+        write_random(int8_t{}, 32, -64, 64);
+    }
+}
+
+TEST_CASE("the network file picks the architecture") {
+    using namespace jchess;
+    std::string small_file = "./nnue_small_test.nnue";
+    write_random_small_network(small_file);
+    NNUEEvaluator standard{"../data/nn-04a843f8932e.nnue"};
+    REQUIRE(standard.get_architecture() == "halfkp_256x2-32-32");
+    NNUEEvaluator reference{small_file, SimdLevel::GENERIC};
+    REQUIRE(reference.get_architecture() == "halfkp_128x2-32-32");
+    std::vector<std::string> fens = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2k5/3p4/p2P1p2/P2P1P2/8/3K4/8 w - - 0 1"
+    };
+    NNUEEvaluator small{small_file};
+    std::vector<PackedPosition> positions;
+    std::vector<int32_t> expected;
+    for(std::string const& fen : fens) {
+        expected.push_back(reference.nnue_eval_fen(fen));
+        REQUIRE(small.nnue_eval_fen(fen) == expected.back());
+        positions.emplace_back(FEN{fen});
+    }
+    std::vector<int32_t> evals(positions.size());
+    small.nnue_eval_batch(positions, evals, 1);
+    REQUIRE(evals == expected);
+    std::filesystem::remove(small_file);
+}
+
 TEST_CASE("debug only") {
     using namespace jchess;
     std::string evil_fen = "r1bqkb1r/pppn1ppp/4p3/3n4/2BP1B2/2N1PN2/PP3PPP/R2QK2R b KQkq - 0 1";
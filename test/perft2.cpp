@@ -1,67 +1,176 @@
-#include "jchess/movegen.h"
 #include "jchess/board.h"
+#include "jchess/perft.h"
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
-#include <cassert>
 #include <unordered_set>
 #include <chrono>
+#include <memory>
+#include <thread>
 
 #include <nlohmann/json.hpp>
 
 using json = nlohmann::json;
 using namespace jchess;
 
-uint64_t perft(int depth, Board& board) {
-    assert(depth >= 0);
+struct PerftOptions {
+    int num_threads = 0; // every core
+    bool divide = false; // print the nodes under each root move at the deepest depth
+    size_t hash_mb = 0; // if set each depth is also run with a perft table of this size, to compare
+    int repeat = 1; // the fastest of this many runs is the time for a depth
+    std::string bench_file; // results written here as json if set
+    std::string baseline_file; // earlier results to compare the nodes per second with
+    double threshold = 10.0; // percent slower than the baseline before it counts as a regression
+};
 
-    if(depth == 0) {
-        return 1ull;
-    }
-
-    uint64_t nodes = 0ull;
-    MoveVector moves;
-    board.generate_legal_moves(moves);
-    for(const auto& move : moves) {
-        board.make_move(move);
-        nodes += perft(depth - 1, board);
-        board.unmake_move();
-    }
-
-    return nodes;
+uint64_t nodes_per_second(uint64_t nodes, double ms) {
+    return ms > 0.0 ? static_cast<uint64_t>(nodes * 1000.0 / ms) : 0ull;
 }
 
-void perft_one_case(int max_depth, std::string const& fen, std::vector<uint64_t> const& expected) {
+// returns the time and count of every depth, and adds the depths that don't match their expected count to mismatches.
+json perft_one_case(int max_depth, std::string const& fen, std::vector<uint64_t> const& expected, PerftOptions const& options, int& mismatches) {
     using std::chrono::high_resolution_clock;
     using std::chrono::duration;
 
     Board board{fen};
+    std::unique_ptr<PerftTable> table;
+    if(options.hash_mb > 0) {
+        table = std::make_unique<PerftTable>(options.hash_mb);
+    }
+    json depths = json::array();
     for(int depth = 1; depth <= max_depth; ++depth) {
-        auto t1 = high_resolution_clock::now();
-        uint64_t actual = perft(depth, board);
-        auto t2 = high_resolution_clock::now();
-        auto n_ms = duration<double, std::milli>(t2 - t1);
+        PerftResult result;
+        double ms = 0.0;
+        for(int run = 0; run < options.repeat; ++run) {
+            auto t1 = high_resolution_clock::now();
+            result = perft_divide(board, depth, options.num_threads);
+            auto t2 = high_resolution_clock::now();
+            double run_ms = duration<double, std::milli>(t2 - t1).count();
+            ms = (run == 0) ? run_ms : std::min(ms, run_ms);
+        }
+        uint64_t hashed_nodes = 0;
         std::cout
             << "depth: " << depth
-            << " actual: " << actual
+            << " actual: " << result.nodes
             << " expected: " << expected[depth-1]
-            << " time: " << n_ms.count() << "ms" << std::endl;
+            << " time: " << ms << "ms";
+        if(table) {
+            // the table is kept from the shallower depths, as it would be in one deep run.
+            auto t1 = high_resolution_clock::now();
+            PerftResult hashed = perft_divide(board, depth, options.num_threads, table.get());
+            auto t2 = high_resolution_clock::now();
+            hashed_nodes = hashed.nodes;
+            double hit_rate = hashed.table_probes ? 100.0 * hashed.table_hits / hashed.table_probes : 0.0;
+            std::cout
+                << " hash_actual: " << hashed.nodes
+                << " hash_time: " << duration<double, std::milli>(t2 - t1).count() << "ms"
+                << " hash_hits: " << hashed.table_hits << "/" << hashed.table_probes
+                << " (" << hit_rate << "%)";
+        }
+        std::cout << std::endl;
+        if(table && hashed_nodes != expected[depth-1]) {
+            std::cout << "MISMATCH at depth " << depth << " (hashed)" << std::endl;
+            ++mismatches;
+        }
+        if(result.nodes != expected[depth-1]) {
+            std::cout << "MISMATCH at depth " << depth << std::endl;
+            ++mismatches;
+        }
+        if(options.divide && depth == max_depth) {
+            for(auto const& [move, nodes] : result.divide) {
+                std::cout << move_to_string(move) << ": " << nodes << std::endl;
+            }
+        }
+        depths.push_back({{"depth", depth}, {"nodes", result.nodes}, {"ms", ms}, {"nps", nodes_per_second(result.nodes, ms)}});
+    }
+    return depths;
+}
+
+json summarise(json const& depths) {
+    uint64_t nodes = 0;
+    double ms = 0.0;
+    for(auto const& depth : depths) {
+        nodes += depth["nodes"].get<uint64_t>();
+        ms += depth["ms"].get<double>();
     }
+    return {{"nodes", nodes}, {"ms", ms}, {"nps", nodes_per_second(nodes, ms)}};
 }
 
-// pass path to json file of test cases to code
+// compares the nodes per second of each position, and of the whole run, with the baseline. returns the
+// number of them more than the threshold slower.
+int compare_with_baseline(json const& bench, json const& baseline, double threshold) {
+    if(baseline.value("threads", 0) != bench["threads"]) {
+        std::cout << "warning: baseline was run with " << baseline.value("threads", 0) << " threads" << std::endl;
+    }
+    if(baseline.value("repeat", 1) != bench["repeat"]) {
+        std::cout << "warning: baseline took the fastest of " << baseline.value("repeat", 1) << " runs" << std::endl;
+    }
+    int regressions = 0;
+    auto compare = [&](std::string const& name, json const& now, json const& before) {
+        double base_nps = before["nps"].get<double>();
+        double change = base_nps > 0.0 ? 100.0 * (now["nps"].get<double>() - base_nps) / base_nps : 0.0;
+        bool regressed = change < -threshold;
+        regressions += regressed;
+        std::cout << name << ": " << now["nps"] << " nps, baseline " << before["nps"] << " nps, "
+                  << (change >= 0.0 ? "+" : "") << change << "%" << (regressed ? " REGRESSION" : "") << std::endl;
+    };
+    for(auto const& position : bench["positions"]) {
+        auto found = std::find_if(baseline["positions"].begin(), baseline["positions"].end(), [&](json const& base) {
+            return base["name"] == position["name"];
+        });
+        if(found == baseline["positions"].end()) {
+            std::cout << position["name"].get<std::string>() << ": not in the baseline" << std::endl;
+            continue;
+        }
+        compare(position["name"].get<std::string>(), position["total"], (*found)["total"]);
+    }
+    compare("total", bench["total"], baseline["total"]);
+    return regressions;
+}
+
+// pass path to json file of test cases to code, then optionally:
+//   --threads N, --divide, --hash MB
+//   --bench OUT.json to write the nodes, ms and nodes per second of every position and depth
+//   --repeat N to time each depth by the fastest of N runs
+//   --baseline OLD.json [--threshold PERCENT] to fail if slower than an earlier --bench by more than the threshold
+// exits with 1 if any count is wrong and 2 if only the speed regressed.
 int main(int argc, char **argv) {
     if(argc == 1) {
         std::cerr << "expected positional argument for name of config file" << std::endl;
         std::exit(1);
     }
     std::string config_name {argv[1]};
+    PerftOptions options;
+    for(int i = 2; i < argc; ++i) {
+        std::string arg {argv[i]};
+        if(arg == "--threads" && i + 1 < argc) {
+            options.num_threads = std::stoi(argv[++i]);
+        } else if(arg == "--divide") {
+            options.divide = true;
+        } else if(arg == "--hash" && i + 1 < argc) {
+            options.hash_mb = std::stoull(argv[++i]);
+        } else if(arg == "--repeat" && i + 1 < argc) {
+            options.repeat = std::max(1, std::stoi(argv[++i]));
+        } else if(arg == "--bench" && i + 1 < argc) {
+            options.bench_file = argv[++i];
+        } else if(arg == "--baseline" && i + 1 < argc) {
+            options.baseline_file = argv[++i];
+        } else if(arg == "--threshold" && i + 1 < argc) {
+            options.threshold = std::stod(argv[++i]);
+        } else {
+            std::cerr << "unknown argument " << arg << std::endl;
+            std::exit(1);
+        }
+    }
     std::ifstream config{config_name};
     json data = json::parse(config);
     std::unordered_set<std::string> exclude;
     for(std::string name : data["exclude"]) {
         exclude.insert(name);
     }
+    int mismatches = 0;
+    json positions = json::array();
     for(const auto& position : data["positions"]) {
         if(exclude.count(position["name"]) == 0) {
             std::string fen = position["fen"];
@@ -70,8 +179,34 @@ int main(int argc, char **argv) {
                 expected.push_back(value);
             }
             std::cout << "Position: " << position["name"] << std::endl;
-            perft_one_case(position["depth"], fen, expected);
+            json depths = perft_one_case(position["depth"], fen, expected, options, mismatches);
+            positions.push_back({{"name", position["name"]}, {"fen", fen}, {"depths", depths}, {"total", summarise(depths)}});
         }
     }
 
+    json all_depths = json::array();
+    for(auto const& position : positions) {
+        all_depths.push_back(position["total"]);
+    }
+    int num_threads = options.num_threads > 0 ? options.num_threads : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    json bench = {{"threads", num_threads}, {"repeat", options.repeat}, {"positions", positions}, {"total", summarise(all_depths)}};
+    if(!options.bench_file.empty()) {
+        std::ofstream out{options.bench_file};
+        out << bench.dump(2) << std::endl;
+    }
+    int regressions = 0;
+    if(!options.baseline_file.empty()) {
+        std::ifstream baseline_in{options.baseline_file};
+        regressions = compare_with_baseline(bench, json::parse(baseline_in), options.threshold);
+    }
+
+    if(mismatches > 0) {
+        std::cout << mismatches << " node count mismatches" << std::endl;
+        return 1;
+    }
+    if(regressions > 0) {
+        std::cout << regressions << " nodes per second regressions over " << options.threshold << "%" << std::endl;
+        return 2;
+    }
+    return 0;
 }
\ No newline at end of file
@@ -3,6 +3,9 @@
 #include "jchess/search.h"
 #include "jchess/eval.h"
 #include "jchess/core.h"
+#include "jchess/nnue/wrap_nnue.h"
+
+#include <memory>
 
 using namespace jchess;
 
@@ -37,7 +40,7 @@ TEST_CASE("behaves well in losing position") {
     std::string all_moves_lose = "1r6/8/8/8/8/8/K5k1/2r5 w - - 0 1";
     Board board{all_moves_lose};
     Searcher searcher;
-    Move best = "0000";
+    Move best = NULL_MOVE;
     searcher.alpha_beta_search(2, board, MIN_SCORE, MAX_SCORE, best, true);
     REQUIRE(move_to_string(best) == "a2a3");
     // a real search can sometimes behave differently due to cancellation.
@@ -50,11 +53,25 @@ TEST_CASE("restricted search basic") {
     Board board{starting_fen};
     Searcher searcher;
     MoveVector moves;
-    moves.emplace_back("a2a4");
-    Move best = "0000";
+    moves.push_back(move_from_uci(board, "a2a4"));
+    Move best = NULL_MOVE;
     searcher.alpha_beta_search(2, board, MIN_SCORE, MAX_SCORE, best, true, moves);
     REQUIRE(move_to_string(best) == "a2a4");
     SearchLimits limits {.max_nodes = 1000, .search_moves = moves };
     auto info = searcher.search(board, limits);
     REQUIRE(move_to_string(info.best_move) == "a2a4");
+}
+
+TEST_CASE("lazy eval only skips the network far from the window") {
+    Board board{starting_fen};
+    Searcher searcher;
+    searcher.enable_nnue_eval(std::make_unique<nnue_eval::NNUEEvaluator>("../data/nn-04a843f8932e.nnue"));
+    SearchLimits limits{ .max_nodes = 20000 };
+    searcher.set_lazy_eval_margin(MAX_SCORE);
+    auto info = searcher.search(board, limits);
+    REQUIRE(info.lazy_eval_hits == 0);
+    REQUIRE(info.lazy_eval_misses > 0);
+    searcher.set_lazy_eval_margin(0);
+    info = searcher.search(board, limits);
+    REQUIRE(info.lazy_eval_hits > 0);
 }
\ No newline at end of file
@@ -0,0 +1,21 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "jchess/board.h"
+#include "jchess/magic_bitboard.h"
+#include "jchess/perft.h"
+
+using namespace jchess;
+
+// a binary of its own: the tests binary switches backends, so it always links the selection code and would hide
+// a default that never gets picked.
+TEST_CASE("default slider backend without selecting one") {
+#ifdef __BMI2__
+    REQUIRE(get_slider_backend() == SliderBackend::PEXT);
+#else
+    REQUIRE(get_slider_backend() == SliderBackend::MAGIC);
+#endif
+    // the tables behind the default have been built
+    static Board board;
+    board.set_position(FEN{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"});
+    REQUIRE(perft(board, 3) == 97862);
+}
\ No newline at end of file
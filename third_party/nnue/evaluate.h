@@ -2,8 +2,10 @@
 #ifndef _NNUE_EVALUATE_H
 #define _NNUE_EVALUATE_H
 
-template <typename ChessInterface> class Evaluator {
+template <typename ChessInterface, typename NetworkType = Network> class Evaluator {
   public:
+    using Network = NetworkType;
+
     template <Color kside>
     static size_t getIndices(const ChessInterface &intf, IndexArray &out) {
         IndexArray::iterator it = out.begin();
@@ -11,7 +13,7 @@ template <typename ChessInterface> class Evaluator {
             const Square &sq = pair.first;
             const Piece &piece = pair.second;
             if (piece != WhiteKing && piece != BlackKing) {
-                *it++ = Network::getIndex<kside>(intf.kingSquare(kside),
+                *it++ = Network::template getIndex<kside>(intf.kingSquare(kside),
                                                  piece, sq);
             }
         }
@@ -34,10 +36,10 @@ template <typename ChessInterface> class Evaluator {
                 continue;
             if (from != InvalidSquare) {
                 removed[removed_count++] =
-                    Network::getIndex<kside>(kp, piece, from);
+                    Network::template getIndex<kside>(kp, piece, from);
             }
             if (to != InvalidSquare) {
-                added[added_count++] = Network::getIndex<kside>(kp, piece, to);
+                added[added_count++] = Network::template getIndex<kside>(kp, piece, to);
             }
         }
     }
@@ -86,7 +88,7 @@ template <typename ChessInterface> class Evaluator {
             targetHalf, ciSource.getAccumulator(), sourceHalf);
         // update based on diffs
         auto it = network.layers.begin();
-        ((Network::FeatureXformer *)*it)
+        ((typename Network::FeatureXformer *)*it)
             ->updateAccum(added, removed, added_count, removed_count,
                           targetHalf, ciTarget.getAccumulator());
         ciTarget.getAccumulator().setState(targetHalf,
@@ -95,7 +97,7 @@ template <typename ChessInterface> class Evaluator {
 
     // Full evaluation of 1/2 of the accumulator for a specified color (c)
     static void updateAccum(const Network &network, const IndexArray &indices, Color c,
-                            Color sideToMove, Network::AccumulatorType &accum) {
+                            Color sideToMove, typename Network::AccumulatorType &accum) {
         auto it = network.layers.begin();
         AccumulatorHalf targetHalf =
             Network::AccumulatorType::getHalf(c, sideToMove);
@@ -103,7 +105,7 @@ template <typename ChessInterface> class Evaluator {
             if (idx == nnue::LAST_INDEX)
                 break;
         }
-        ((Network::FeatureXformer *)*it)->updateAccum(indices, targetHalf, accum);
+        ((typename Network::FeatureXformer *)*it)->updateAccum(indices, targetHalf, accum);
         accum.setState(targetHalf,AccumulatorState::Computed);
     }
 
@@ -111,7 +113,7 @@ template <typename ChessInterface> class Evaluator {
     static void updateAccum(const Network &network, ChessInterface &intf,
                             const Color c) {
         // see if incremental update is possible
-        Network::AccumulatorType &accum = intf.getAccumulator();
+        typename Network::AccumulatorType &accum = intf.getAccumulator();
         int gain = intf.pieceCount() - 2; // pieces minus Kings
         AccumulatorHalf half;
         AccumulatorHalf targetHalf = half =
@@ -149,24 +151,24 @@ template <typename ChessInterface> class Evaluator {
             else
                 getIndices<Black>(intf, indices);
             auto it = network.layers.begin();
-            ((Network::FeatureXformer *)*it)->updateAccum(indices, targetHalf, accum);
+            ((typename Network::FeatureXformer *)*it)->updateAccum(indices, targetHalf, accum);
         }
         accum.setState(targetHalf,AccumulatorState::Computed);
     }
 
     // evaluate the net (full evaluation)
-    static Network::OutputType fullEvaluate(const Network &network,
+    static typename Network::OutputType fullEvaluate(const Network &network,
                                             ChessInterface &intf) {
         // Do not use the accumulator from intf, because we don't assume there's
         // a valid Node pointer in it.
-        Network::AccumulatorType accum;
+        typename Network::AccumulatorType accum;
         updateAccum(network, intf, accum);
         return network.evaluate(accum);
     }
 
 private:
     // full evaluation, update into 3rd argument
-    static void updateAccum(const Network &network, ChessInterface &intf, Network::AccumulatorType &accum) {
+    static void updateAccum(const Network &network, ChessInterface &intf, typename Network::AccumulatorType &accum) {
         Color colors[] = {White, Black};
         for (Color color : colors) {
             IndexArray indices;
@@ -176,7 +178,7 @@ private:
                 getIndices<Black>(intf, indices);
             AccumulatorHalf targetHalf =
               Network::AccumulatorType::getHalf(intf.sideToMove(), color);
-            reinterpret_cast<Network::FeatureXformer *>(*(network.layers.begin()))->updateAccum(indices, targetHalf, accum);
+            reinterpret_cast<typename Network::FeatureXformer *>(*(network.layers.begin()))->updateAccum(indices, targetHalf, accum);
             accum.setState(targetHalf,AccumulatorState::Computed);
         }
     }
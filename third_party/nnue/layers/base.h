@@ -20,6 +20,17 @@ class BaseLayer {
 
     virtual std::istream &read(std::istream &s) { return s; }
 
+    // size of the layer's parameters in their in-memory layout
+    virtual size_t imageSize() const noexcept { return 0; }
+
+    // write the parameters in their in-memory layout
+    virtual void writeImage(std::ostream &s) const { (void)s; }
+
+    // use parameters written by writeImage in place (typically a mapped
+    // file) instead of a copy. data must be IMAGE_ALIGN aligned and outlive
+    // the layer. Returns the end of this layer's parameters.
+    virtual const std::byte *mapImage(const std::byte *data) { return data; }
+
     virtual void zero() {}
 };
 
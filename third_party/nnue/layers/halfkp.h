@@ -13,7 +13,7 @@ template <typename InputType, typename WeightType, typename BiasType, typename O
 class HalfKp : public TypedLayer<InputType, OutputType, inputSize, outputSize, alignment>
 {
 public:
-    HalfKp() = default;
+    HalfKp() : _owned(new Parameters), _params(_owned.get()) {}
 
     virtual ~HalfKp() = default;
 
@@ -39,9 +39,9 @@ public:
     // Propagate data through the layer, updating the specified half of the
     // accumulator (side to move goes in lower half).
     inline void updateAccum(const IndexArray &indices, AccumulatorHalf half, AccumulatorType &output) {
-        output.init_half(half,this->_biases);
+        output.init_half(half,_params->biases);
         for (auto it = indices.begin(); it != indices.end() && *it != LAST_INDEX; ++it) {
-            output.add_half(half,this->_weights[*it]);
+            output.add_half(half,_params->weights[*it]);
         }
     }
 
@@ -50,10 +50,10 @@ public:
                      size_t added_count, size_t removed_count,
                      AccumulatorHalf half, AccumulatorType &output) {
       for (size_t i = 0; i < added_count; i++) {
-	   output.add_half(half, this->_weights[added[i]]);
+	   output.add_half(half, _params->weights[added[i]]);
       }
       for (size_t i = 0; i < removed_count; i++) {
-	  output.sub_half(half, this->_weights[removed[i]]);
+	  output.sub_half(half, _params->weights[removed[i]]);
       }
     }
     
@@ -62,24 +62,39 @@ public:
     }
 
     virtual std::istream &read(std::istream &s) {
+        Parameters &params = ownParameters();
         for (size_t i = 0; i < outputSize && s.good(); ++i) {
-            _biases[i] = read_little_endian<BiasType>(s);
+            params.biases[i] = read_little_endian<BiasType>(s);
         }
         for (size_t i = 0; i < inputSize && s.good(); ++i) {
             for (size_t j = 0; j < outputSize && s.good(); ++j) {
-                _weights[i][j] = read_little_endian<WeightType>(s);
+                params.weights[i][j] = read_little_endian<WeightType>(s);
             }
         }
         return s;
     }
 
+    virtual size_t imageSize() const noexcept { return sizeof(Parameters); }
+
+    virtual void writeImage(std::ostream &s) const {
+        s.write(reinterpret_cast<const char *>(_params), sizeof(Parameters));
+    }
+
+    virtual const std::byte *mapImage(const std::byte *data) {
+        assert(reinterpret_cast<uintptr_t>(data) % IMAGE_ALIGN == 0);
+        _owned.reset();
+        _params = reinterpret_cast<const Parameters *>(data);
+        return data + sizeof(Parameters);
+    }
+
     virtual const WeightType *getCol(size_t row) const noexcept {
-        return _weights[row];
+        return _params->weights[row];
     }
 
     virtual void setCol(size_t row, const WeightType *col) {
+        Parameters &params = ownParameters();
         for (size_t i = 0; i < outputSize; ++i)
-           _weights[row][i] = col[i];
+           params.weights[row][i] = col[i];
     }
 
 private:
@@ -87,9 +102,26 @@ private:
         {0, 0}, {1, 2}, {3, 4}, {5, 6}, {7, 8}, {9, 10}, {11, 12}, {0, 0},
         {0, 0}, {2, 1}, {4, 3}, {6, 5}, {8, 7}, {10, 9}, {12, 11}, {0, 0}};
 
-    alignas(alignment) BiasType _biases[outputSize];
-    alignas(alignment) WeightType _weights[inputSize][outputSize];
+    static constexpr size_t paramAlign = std::max(alignment, IMAGE_ALIGN);
+
+    // the layout of the parameters is the same for every alignment, so a
+    // network image can be used by any of the SIMD variants
+    struct Parameters {
+        alignas(paramAlign) BiasType biases[outputSize];
+        alignas(paramAlign) WeightType weights[inputSize][outputSize];
+    };
+
+    // writable parameters, taking a copy if they are mapped
+    Parameters &ownParameters() {
+        if (!_owned) {
+            _owned.reset(new Parameters(*_params));
+            _params = _owned.get();
+        }
+        return *_owned;
+    }
 
+    std::unique_ptr<Parameters> _owned;
+    const Parameters *_params;
 };
 
 #endif
@@ -5,6 +5,8 @@
 #include "nndefs.h"
 #include "typed.h"
 
+#include <type_traits>
+
 // This class defines a linear transformation layer of the NNUE.
 //
 template <typename InputType, typename WeightType, typename BiasType,
@@ -13,79 +15,179 @@ template <typename InputType, typename WeightType, typename BiasType,
 class LinearLayer : public TypedLayer<InputType, OutputType, inputSize,
                                       outputSize, alignment> {
   public:
-    LinearLayer() = default;
+    LinearLayer() : _owned(new Parameters), _params(_owned.get()) {}
 
     virtual ~LinearLayer() = default;
 
+    // A wide layer fed by 8-bit activations (the first hidden layer) sees mostly
+    // zero inputs, so it skips the zero chunks of 4 inputs. This uses a copy
+    // of the weights grouped by input chunk, built when they are read.
+    static constexpr size_t sparseChunkSize = 4;
+    static constexpr bool sparseInput =
+        std::is_same_v<InputType, uint8_t> && std::is_same_v<WeightType, int8_t> &&
+        std::is_same_v<OutputType, int32_t> && outputSize == 32 &&
+        inputSize > 32 && inputSize % 64 == 0;
+
+    static constexpr size_t sparseWeightIndex(size_t row, size_t col) {
+        return (col / sparseChunkSize) * outputSize * sparseChunkSize +
+               row * sparseChunkSize + col % sparseChunkSize;
+    }
+
     // propagate data through the layer
     virtual inline void doForward(const InputType *input,
                                   OutputType *output) const noexcept {
-        dotProduct(input, output);
+        if constexpr (sparseInput) {
+            sparseDotProduct(input, output);
+        } else {
+            dotProduct(input, output);
+        }
+    }
+
+    inline void sparseDotProduct(const InputType *input,
+                                 OutputType *output) const noexcept {
+        uint16_t nnz[inputSize / sparseChunkSize];
+#if defined(SIMD)
+        const size_t count = simd::findNnzChunks<inputSize>(input, nnz);
+        simd::sparseDotProductnx32<inputSize, outputSize>(
+            input, _params->sparseWeights, nnz, count, _params->biases, output);
+#else
+        size_t count = 0;
+        for (size_t c = 0; c < inputSize / sparseChunkSize; ++c) {
+            uint32_t chunk;
+            std::memcpy(&chunk, input + c * sparseChunkSize, sizeof(chunk));
+            if (chunk) {
+                nnz[count++] = static_cast<uint16_t>(c);
+            }
+        }
+        for (size_t i = 0; i < outputSize; i++) {
+            output[i] = static_cast<OutputType>(_params->biases[i]);
+        }
+        for (size_t n = 0; n < count; ++n) {
+            const InputType *in = input + nnz[n] * sparseChunkSize;
+            const WeightType *w = _params->sparseWeights + sparseWeightIndex(0, nnz[n] * sparseChunkSize);
+            for (size_t i = 0; i < outputSize; i++) {
+                for (size_t k = 0; k < sparseChunkSize; k++) {
+                    output[i] += static_cast<OutputType>(in[k] * w[i * sparseChunkSize + k]);
+                }
+            }
+        }
+#endif
     }
 
     inline void dotProduct(const InputType *input, OutputType *output) const
         noexcept {
 #if defined(SIMD)
         if constexpr (outputSize == 1) { // output layer
-            simd::dotProduct32x1(input,_weights[0],_biases,output);
+            simd::dotProduct32x1(input,_params->weights[0],_params->biases,output);
         }
         else if constexpr (outputSize == 32) {
-            simd::dotProductnx32<inputSize,outputSize>(input,_weights,_biases,output);
+            simd::dotProductnx32<inputSize,outputSize>(input,_params->weights,_params->biases,output);
         }
         else
 #endif
         {
             // generic implementation
             for (size_t i = 0; i < outputSize; i++) {
-                output[i] = static_cast<OutputType>(this->_biases[i]);
+                output[i] = static_cast<OutputType>(_params->biases[i]);
             }
             for (size_t i = 0; i < outputSize; i++) {
                 for (size_t j = 0; j < inputSize; j++) {
                     output[i] +=
-                        static_cast<OutputType>(input[j] * this->_weights[i][j]);
+                        static_cast<OutputType>(input[j] * _params->weights[i][j]);
                 }
             }
         }
     }
 
     virtual void zero() {
+        Parameters &params = ownParameters();
         for (size_t i = 0; i < outputSize; ++i) {
-            _biases[i] = 0;
+            params.biases[i] = 0;
         }
         for (size_t i = 0; i < outputSize; ++i) {
             for (size_t j = 0; j < inputSize; ++j) {
-                _weights[i][j] = 0;
+                params.weights[i][j] = 0;
             }
         }
+        updateSparseWeights();
     }
 
     virtual std::istream &read(std::istream &s) {
         // Note: linear layers are stored in column order
+        Parameters &params = ownParameters();
         for (size_t i = 0; i < outputSize && s.good(); ++i) {
-            _biases[i] = read_little_endian<BiasType>(s);
+            params.biases[i] = read_little_endian<BiasType>(s);
         }
         for (size_t i = 0; i < outputSize && s.good(); ++i) {
             for (size_t j = 0; j < inputSize && s.good(); ++j) {
-                _weights[i][j] = read_little_endian<WeightType>(s);
+                params.weights[i][j] = read_little_endian<WeightType>(s);
             }
         }
+        updateSparseWeights();
         return s;
     }
 
-    virtual const BiasType *getBiases() const noexcept { return _biases; }
+    virtual size_t imageSize() const noexcept { return sizeof(Parameters); }
+
+    // includes the sparse layout of the weights, so nothing is rebuilt when
+    // the image is mapped
+    virtual void writeImage(std::ostream &s) const {
+        s.write(reinterpret_cast<const char *>(_params), sizeof(Parameters));
+    }
+
+    virtual const std::byte *mapImage(const std::byte *data) {
+        assert(reinterpret_cast<uintptr_t>(data) % IMAGE_ALIGN == 0);
+        _owned.reset();
+        _params = reinterpret_cast<const Parameters *>(data);
+        return data + sizeof(Parameters);
+    }
+
+    virtual const BiasType *getBiases() const noexcept { return _params->biases; }
 
     virtual const WeightType *getCol(size_t col) const noexcept {
-        return _weights[col];
+        return _params->weights[col];
     }
 
     virtual void setCol(size_t index, const WeightType *col) {
+        Parameters &params = ownParameters();
         for (size_t i = 0; i < inputSize; ++i)
-            _weights[index][i] = col[i];
+            params.weights[index][i] = col[i];
+        updateSparseWeights();
     }
 
   private:
-    alignas(alignment) BiasType _biases[outputSize];
-    alignas(alignment) WeightType _weights[outputSize][inputSize];
+    void updateSparseWeights() {
+        if constexpr (sparseInput) {
+            Parameters &params = ownParameters();
+            for (size_t i = 0; i < outputSize; ++i) {
+                for (size_t j = 0; j < inputSize; ++j) {
+                    params.sparseWeights[sparseWeightIndex(i, j)] = params.weights[i][j];
+                }
+            }
+        }
+    }
+
+    static constexpr size_t paramAlign = std::max(alignment, IMAGE_ALIGN);
+
+    // the layout of the parameters is the same for every alignment, so a
+    // network image can be used by any of the SIMD variants
+    struct Parameters {
+        alignas(paramAlign) BiasType biases[outputSize];
+        alignas(paramAlign) WeightType weights[outputSize][inputSize];
+        alignas(paramAlign) WeightType sparseWeights[sparseInput ? inputSize * outputSize : 1];
+    };
+
+    // writable parameters, taking a copy if they are mapped
+    Parameters &ownParameters() {
+        if (!_owned) {
+            _owned.reset(new Parameters(*_params));
+            _params = _owned.get();
+        }
+        return *_owned;
+    }
+
+    std::unique_ptr<Parameters> _owned;
+    const Parameters *_params;
 };
 
 #endif
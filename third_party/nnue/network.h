@@ -10,36 +10,88 @@
 #include "layers/scaleclamp.h"
 #include "util.h"
 
-class Network {
+// A network architecture: the feature set (the first layer, which turns the
+// position into the accumulator, transformerSize wide for each side), then two
+// hidden layers and a single output. The hidden layers are 32 wide for the
+// SIMD kernels. Several architectures can be compiled in, a network file's
+// header hash says which one it uses.
+template <size_t transformerSize, size_t hidden1Size, size_t hidden2Size>
+struct HalfKpArchitecture {
+    static constexpr size_t FeatureXformerRows = 64 * (10 * 64 + 1);
+    static constexpr size_t FeatureXformerOutputSize = transformerSize;
+    static constexpr size_t Hidden1Size = hidden1Size;
+    static constexpr size_t Hidden2Size = hidden2Size;
+    using FeatureXformer = HalfKp<uint16_t, int16_t, int16_t, int16_t, FeatureXformerRows,
+                                  FeatureXformerOutputSize>;
+    // Stockfish's HalfKP<Friend> feature set hash
+    static constexpr uint32_t FeatureHash = (0x5D69D5B9u ^ 1u) ^ (transformerSize * 2);
+};
+
+// the Stockfish 12 network (nn-04a843f8932e.nnue)
+using HalfKp256Architecture = HalfKpArchitecture<256, 32, 32>;
+// a quarter of the first layer work, trading accuracy for speed
+using HalfKp128Architecture = HalfKpArchitecture<128, 32, 32>;
+
+template <typename Architecture>
+class BasicNetwork {
 
-    template <typename ChessInterface> friend class Evaluator;
+    template <typename ChessInterface, typename NetworkType> friend class Evaluator;
 
   public:
-    static constexpr size_t FeatureXformerRows = 64 * (10 * 64 + 1);
-    static constexpr size_t FeatureXformerOutputSize = 256;
+    static constexpr size_t FeatureXformerRows = Architecture::FeatureXformerRows;
+    static constexpr size_t FeatureXformerOutputSize = Architecture::FeatureXformerOutputSize;
+    static constexpr size_t Hidden1Size = Architecture::Hidden1Size;
+    static constexpr size_t Hidden2Size = Architecture::Hidden2Size;
 
     using IndexArray = std::array<int, MAX_INDICES>;
     using OutputType = int32_t;
     using InputType = uint8_t; // output of transformer
-    using FeatureXformer = HalfKp<uint16_t, int16_t, int16_t, int16_t, FeatureXformerRows,
-                          FeatureXformerOutputSize>;
-    using AccumulatorType = FeatureXformer::AccumulatorType;
+    using FeatureXformer = typename Architecture::FeatureXformer;
+    using AccumulatorType = typename FeatureXformer::AccumulatorType;
     using AccumulatorOutputType = int16_t;
-    using Layer2 = LinearLayer<uint8_t, int8_t, int32_t, int32_t, FeatureXformerOutputSize*2, 32>;
-    using Layer3 = LinearLayer<uint8_t, int8_t, int32_t, int32_t, 32, 32>;
-    using Layer4 = LinearLayer<uint8_t, int8_t, int32_t, int32_t, 32, 1>;
-    using ScaleAndClamper = ScaleAndClamp<int32_t, uint8_t, 32, 6>;
+    using Layer2 = LinearLayer<uint8_t, int8_t, int32_t, int32_t, FeatureXformerOutputSize*2, Hidden1Size>;
+    using Layer3 = LinearLayer<uint8_t, int8_t, int32_t, int32_t, Hidden1Size, Hidden2Size>;
+    using Layer4 = LinearLayer<uint8_t, int8_t, int32_t, int32_t, Hidden2Size, 1>;
+    using ScaleAndClamper2 = ScaleAndClamp<int32_t, uint8_t, Hidden1Size, 6>;
+    using ScaleAndClamper3 = ScaleAndClamp<int32_t, uint8_t, Hidden2Size, 6>;
     using Clamper = Clamp<int16_t, uint8_t, FeatureXformerOutputSize*2>;
 
     static constexpr size_t BUFFER_SIZE = 2048;
 
-    Network() {
+    // the hash in the network file header, computed the way Stockfish does
+    // for its InputSlice -> (AffineTransform -> ClippedReLU) x 2 ->
+    // AffineTransform network
+    static constexpr uint32_t architectureHash() {
+        auto affine = [](uint32_t previous, uint32_t outputSize) {
+            uint32_t hash = 0xCC03DAE4u + outputSize;
+            hash ^= previous >> 1;
+            hash ^= previous << 31;
+            return hash;
+        };
+        auto clippedRelu = [](uint32_t previous) { return 0x538D24C7u + previous; };
+        uint32_t hash = 0xEC42E90Du ^ static_cast<uint32_t>(FeatureXformerOutputSize * 2);
+        hash = clippedRelu(affine(hash, Hidden1Size));
+        hash = clippedRelu(affine(hash, Hidden2Size));
+        hash = affine(hash, 1);
+        return Architecture::FeatureHash ^ hash;
+    }
+
+    // size of the network file after the header and architecture string
+    static constexpr size_t fileParametersSize() {
+        return 2 * sizeof(uint32_t) +
+               FeatureXformerOutputSize * sizeof(int16_t) * (1 + FeatureXformerRows) +
+               Hidden1Size * (sizeof(int32_t) + FeatureXformerOutputSize * 2) +
+               Hidden2Size * (sizeof(int32_t) + Hidden1Size) +
+               sizeof(int32_t) + Hidden2Size;
+    }
+
+    BasicNetwork() {
         layers.push_back(new FeatureXformer());
         layers.push_back(new Clamper(127));
         layers.push_back(new Layer2());
-        layers.push_back(new ScaleAndClamper(127));
+        layers.push_back(new ScaleAndClamper2(127));
         layers.push_back(new Layer3());
-        layers.push_back(new ScaleAndClamper(127));
+        layers.push_back(new ScaleAndClamper3(127));
         layers.push_back(new Layer4());
 #ifndef NDEBUG
         size_t bufferSize = 0;
@@ -51,7 +103,7 @@ class Network {
 #endif
     }
 
-    virtual ~Network() {
+    virtual ~BasicNetwork() {
         for (auto layer : layers) {
             delete layer;
         }
@@ -60,14 +112,18 @@ class Network {
     template <Color kside>
     inline static unsigned getIndex(Square kp, Piece p, Square sq) {
 #ifdef NDEBUG
-        return FeatureXformer::getIndex<kside>(kp, p, sq);
+        return FeatureXformer::template getIndex<kside>(kp, p, sq);
 #else
-        auto idx = FeatureXformer::getIndex<kside>(kp, p, sq);
+        auto idx = FeatureXformer::template getIndex<kside>(kp, p, sq);
         assert(idx < FeatureXformerRows);
         return idx;
 #endif
     }
 
+    const FeatureXformer *getFeatureXformer() const noexcept {
+        return static_cast<const FeatureXformer *>(layers.front());
+    }
+
     // evaluate the net (layers past the first one)
     OutputType evaluate(const AccumulatorType &accum) const {
         alignas(nnue::DEFAULT_ALIGN) std::byte buffer[BUFFER_SIZE];
@@ -121,7 +177,82 @@ class Network {
                FV_SCALE;
     }
 
-    friend std::istream &operator>>(std::istream &i, Network &);
+    std::istream &read(std::istream &s);
+
+    // A network image holds the parameters of every layer in the layout they
+    // have in memory, so it can be memory mapped and used in place, shared by
+    // every process that maps it. It is only valid on hosts with the same
+    // endianness and for the same network architecture.
+    struct alignas(IMAGE_ALIGN) ImageHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint32_t architecture;
+        uint64_t parametersSize;
+    };
+
+    static constexpr char IMAGE_MAGIC[8] = {'N', 'N', 'U', 'E', 'I', 'M', 'G', '\0'};
+    static constexpr uint32_t IMAGE_VERSION = 2;
+    static constexpr uint32_t IMAGE_BYTE_ORDER = 0x01020304;
+
+    size_t imageParametersSize() const noexcept {
+        size_t size = 0;
+        for (auto layer : layers) {
+            size += layer->imageSize();
+        }
+        return size;
+    }
+
+    static bool isImage(const std::byte *data, size_t size) {
+        return size >= sizeof(ImageHeader) &&
+               std::memcmp(data, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) == 0;
+    }
+
+    // the architecture hash of an image, 0 if it isn't one
+    static uint32_t imageArchitecture(const std::byte *data, size_t size) {
+        if (!isImage(data, size)) {
+            return 0;
+        }
+        ImageHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        return header.architecture;
+    }
+
+    void writeImage(std::ostream &s) const {
+        ImageHeader header{};
+        std::memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+        header.version = IMAGE_VERSION;
+        header.byteOrder = IMAGE_BYTE_ORDER;
+        header.architecture = architectureHash();
+        header.parametersSize = imageParametersSize();
+        s.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        for (auto layer : layers) {
+            layer->writeImage(s);
+        }
+    }
+
+    // use the parameters of an image in place, data must be IMAGE_ALIGN aligned
+    // (a mapped file is) and outlive the network
+    bool mapImage(const std::byte *data, size_t size) {
+        if (!isImage(data, size)) {
+            std::cerr << "not a network image" << std::endl;
+            return false;
+        }
+        ImageHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        if (header.version != IMAGE_VERSION || header.byteOrder != IMAGE_BYTE_ORDER ||
+            header.architecture != architectureHash() ||
+            header.parametersSize != imageParametersSize() ||
+            size < sizeof(header) + header.parametersSize) {
+            std::cerr << "network image does not match this network" << std::endl;
+            return false;
+        }
+        const std::byte *params = data + sizeof(header);
+        for (auto layer : layers) {
+            params = layer->mapImage(params);
+        }
+        return true;
+    }
 
     static constexpr unsigned map[16][2] = {
         {0, 0}, {1, 2}, {3, 4}, {5, 6}, {7, 8}, {9, 10}, {11, 12}, {0, 0},
@@ -136,7 +267,8 @@ class Network {
     std::vector<BaseLayer *> layers;
 };
 
-inline std::istream &operator>>(std::istream &s, nnue::Network &network) {
+template <typename Architecture>
+inline std::istream &BasicNetwork<Architecture>::read(std::istream &s) {
     std::uint32_t version, size;
     version = read_little_endian<uint32_t>(s);
     // TBD: validate hash
@@ -159,7 +291,7 @@ inline std::istream &operator>>(std::istream &s, nnue::Network &network) {
     }
     //    std::cout << std::endl;
     unsigned n = 0;
-    for (auto layer : network.layers) {
+    for (auto layer : layers) {
         if (!s.good())
             break;
         // for Stockfish compatiblity: first two layers contain a hash
@@ -171,11 +303,28 @@ inline std::istream &operator>>(std::istream &s, nnue::Network &network) {
         (void)layer->read(s);
     }
 
-    if (n != network.layers.size()) {
+    if (n != layers.size()) {
         std::cerr << "network file read incomplete" << std::endl;
         s.setstate(std::ios::failbit);
     }
     return s;
 }
 
+template <typename Architecture>
+inline std::istream &operator>>(std::istream &s, BasicNetwork<Architecture> &network) {
+    return network.read(s);
+}
+
+// read the architecture hash from a network file header, leaving the stream
+// where it was
+inline uint32_t readArchitectureHash(std::istream &s) {
+    auto start = s.tellg();
+    (void)read_little_endian<uint32_t>(s);
+    uint32_t hash = read_little_endian<uint32_t>(s);
+    s.seekg(start);
+    return hash;
+}
+
+using Network = BasicNetwork<HalfKp256Architecture>;
+
 #endif
@@ -2,7 +2,15 @@
 #ifndef _NNUE_NNDEFS_H
 #define _NNUE_NNDEFS_H
 
+// 512 bit loads and stores need 64 byte alignment
+#ifdef AVX512
+static constexpr size_t DEFAULT_ALIGN = 64;
+#else
 static constexpr size_t DEFAULT_ALIGN = 32;
+#endif
+// alignment of the layer parameters in a network image (see
+// Network::writeImage), enough for any of the SIMD variants
+static constexpr size_t IMAGE_ALIGN = 64;
 static constexpr size_t MAX_INDICES = 32;
 
 using IndexType = unsigned;
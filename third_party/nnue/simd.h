@@ -15,20 +15,22 @@ namespace simd {
 #ifdef AVX512
     using vec_t = __m512i;
     static constexpr size_t simdWidth = 512;
-    static const vec_t ones512 = _mm512_set1_epi16(1);
-    static const __m256i ones256 = _mm256_set1_epi16(1);
+    // functions rather than globals, so no vector instructions run during static initialisation
+    // when the kernels are compiled for an instruction set the host may not have.
+    static inline vec_t ones512() { return _mm512_set1_epi16(1); }
+    static inline __m256i ones256() { return _mm256_set1_epi16(1); }
 #elif defined(AVX2)
     using vec_t = __m256i;
     static constexpr size_t simdWidth = 256;
-    static const vec_t ones256 = _mm256_set1_epi16(1);
+    static inline vec_t ones256() { return _mm256_set1_epi16(1); }
 #elif defined(SSE2) || defined(SSSE3)
     using vec_t = __m128i;
-    static const vec_t ones128 = _mm_set1_epi16(1);
+    static inline vec_t ones128() { return _mm_set1_epi16(1); }
     static constexpr size_t simdWidth = 128;
 #elif defined(NEON)
     using vec_t = int16x8_t;
-    static const vec_t ones128 = vdupq_n_s16(1);
-    static const vec_t zeros128 = vdupq_n_s16(0);
+    static inline vec_t ones128() { return vdupq_n_s16(1); }
+    static inline vec_t zeros128() { return vdupq_n_s16(0); }
     static constexpr size_t simdWidth = 128;
 #else
 #error must set at least one of: AVX512, AVX2, SSSE3, SSE2 or NEON
@@ -61,7 +63,7 @@ void inline mm512_add_dpbusd_epi32(__m512i& acc, __m512i a, __m512i b) {
     acc = _mm512_dpbusd_epi32(acc, a, b);
 #else
     __m512i x = _mm512_maddubs_epi16(a, b);
-    x = _mm512_madd_epi16(x, ones512);
+    x = _mm512_madd_epi16(x, ones512());
     acc = _mm512_add_epi32(acc, x);
 #endif
 }
@@ -73,7 +75,7 @@ void inline mm512_add_dpbusd_epi32(__m512i& acc, __m512i a, __m512i b) {
     acc = _mm256_dpbusd_epi32(acc, a, b);
 #else
     __m256i x = _mm256_maddubs_epi16(a, b);
-    x = _mm256_madd_epi16(x, ones256);
+    x = _mm256_madd_epi16(x, ones256());
     acc = _mm256_add_epi32(acc, x);
 #endif
 }
@@ -89,7 +91,7 @@ static inline void dotProduct32x1(const uint8_t *input, const int8_t *weights,
     __m256i prod = _mm256_dpbusd_epi32(_mm256_setzero_si256(), inp[0], row[0]);
 #else
     __m256i prod = _mm256_maddubs_epi16(inp[0], row[0]);
-    prod = _mm256_madd_epi16(prod, ones256);
+    prod = _mm256_madd_epi16(prod, ones256());
 #endif
     __m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(prod),
                                    _mm256_extracti128_si256(prod, 1));
@@ -99,8 +101,8 @@ static inline void dotProduct32x1(const uint8_t *input, const int8_t *weights,
 #elif defined(SSSE3)
     const vec_t *inp = reinterpret_cast<const vec_t *>(input);
     const vec_t *row = reinterpret_cast<const vec_t *>(weights);
-    vec_t p0 = _mm_madd_epi16(_mm_maddubs_epi16(inp[0], row[0]), ones128);
-    vec_t p1 = _mm_madd_epi16(_mm_maddubs_epi16(inp[1], row[1]), ones128);
+    vec_t p0 = _mm_madd_epi16(_mm_maddubs_epi16(inp[0], row[0]), ones128());
+    vec_t p1 = _mm_madd_epi16(_mm_maddubs_epi16(inp[1], row[1]), ones128());
     vec_t sum = _mm_add_epi32(p0, p1);
     sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xb));
 #ifdef SSE41
@@ -251,6 +253,174 @@ inline void dotProductnx32(const uint8_t *input,
 #endif
 }
 
+// Sparse propagation, for layers whose input is mostly zero (the clamped
+// feature transformer output). The input is scanned in chunks of 4 bytes and
+// only the non-zero chunks are multiplied. The weights are laid out by chunk:
+// for each chunk, the 4 weights of output 0, then output 1, ... (see
+// LinearLayer::sparseWeightIndex).
+
+// writes the indices of the non-zero 4 byte chunks of input to nnz, returns
+// their count
+template <size_t inputSize>
+inline size_t findNnzChunks(const uint8_t *input, uint16_t *nnz) {
+    size_t count = 0;
+#if defined(AVX512)
+    static_assert(inputSize % 64 == 0);
+    const vec_t *inp = reinterpret_cast<const vec_t *>(input);
+    for (unsigned i = 0; i < inputSize / 64; ++i) {
+        unsigned mask = _mm512_test_epi32_mask(inp[i], inp[i]);
+        while (mask) {
+            nnz[count++] = static_cast<uint16_t>(16 * i + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+#elif defined(AVX2)
+    static_assert(inputSize % 32 == 0);
+    const vec_t *inp = reinterpret_cast<const vec_t *>(input);
+    const vec_t zeros = _mm256_setzero_si256();
+    for (unsigned i = 0; i < inputSize / 32; ++i) {
+        unsigned mask = ~_mm256_movemask_ps(_mm256_castsi256_ps(
+                            _mm256_cmpeq_epi32(inp[i], zeros))) & 0xff;
+        while (mask) {
+            nnz[count++] = static_cast<uint16_t>(8 * i + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+#elif defined(SSE2) || defined(SSSE3)
+    static_assert(inputSize % 16 == 0);
+    const vec_t *inp = reinterpret_cast<const vec_t *>(input);
+    const vec_t zeros = _mm_setzero_si128();
+    for (unsigned i = 0; i < inputSize / 16; ++i) {
+        unsigned mask = ~_mm_movemask_ps(_mm_castsi128_ps(
+                            _mm_cmpeq_epi32(inp[i], zeros))) & 0xf;
+        while (mask) {
+            nnz[count++] = static_cast<uint16_t>(4 * i + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+#elif defined(NEON) && defined(__aarch64__)
+    static_assert(inputSize % 16 == 0);
+    const uint32_t *inp = reinterpret_cast<const uint32_t *>(input);
+    const uint32x4_t bits = {1, 2, 4, 8};
+    for (unsigned i = 0; i < inputSize / 16; ++i) {
+        uint32x4_t chunk = vld1q_u32(inp + 4 * i);
+        unsigned mask = vaddvq_u32(vandq_u32(vtstq_u32(chunk, chunk), bits));
+        while (mask) {
+            nnz[count++] = static_cast<uint16_t>(4 * i + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+#else
+    const uint32_t *inp = reinterpret_cast<const uint32_t *>(input);
+    for (unsigned i = 0; i < inputSize / 4; ++i) {
+        if (inp[i]) {
+            nnz[count++] = static_cast<uint16_t>(i);
+        }
+    }
+#endif
+    return count;
+}
+
+template <size_t inputSize, size_t outputSize>
+inline void sparseDotProductnx32(const uint8_t *input, const int8_t *weights,
+                                 const uint16_t *nnz, size_t count,
+                                 const int32_t *biases, int32_t *output) {
+    static_assert(outputSize == 32);
+    // each chunk of 4 inputs is broadcast and multiplied with its 32x4 weights
+    constexpr size_t chunkWeights = outputSize * 4;
+    const int32_t *in32 = reinterpret_cast<const int32_t *>(input);
+#if defined(AVX512)
+    vec_t acc0 = _mm512_loadu_si512(biases);
+    vec_t acc1 = _mm512_loadu_si512(biases + 16);
+    for (size_t n = 0; n < count; ++n) {
+        const vec_t in = _mm512_set1_epi32(in32[nnz[n]]);
+        const vec_t *w = reinterpret_cast<const vec_t *>(weights + nnz[n] * chunkWeights);
+        mm512_add_dpbusd_epi32(acc0, in, w[0]);
+        mm512_add_dpbusd_epi32(acc1, in, w[1]);
+    }
+    _mm512_storeu_si512(output, acc0);
+    _mm512_storeu_si512(output + 16, acc1);
+#elif defined(AVX2)
+    __m256i acc[4];
+    for (unsigned k = 0; k < 4; ++k) {
+        acc[k] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(biases + 8 * k));
+    }
+    for (size_t n = 0; n < count; ++n) {
+        const __m256i in = _mm256_set1_epi32(in32[nnz[n]]);
+        const __m256i *w = reinterpret_cast<const __m256i *>(weights + nnz[n] * chunkWeights);
+        for (unsigned k = 0; k < 4; ++k) {
+            mm256_add_dpbusd_epi32(acc[k], in, w[k]);
+        }
+    }
+    for (unsigned k = 0; k < 4; ++k) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + 8 * k), acc[k]);
+    }
+#elif defined(SSSE3)
+    vec_t acc[8];
+    for (unsigned k = 0; k < 8; ++k) {
+        acc[k] = _mm_loadu_si128(reinterpret_cast<const vec_t *>(biases + 4 * k));
+    }
+    for (size_t n = 0; n < count; ++n) {
+        const vec_t in = _mm_set1_epi32(in32[nnz[n]]);
+        const vec_t *w = reinterpret_cast<const vec_t *>(weights + nnz[n] * chunkWeights);
+        for (unsigned k = 0; k < 8; ++k) {
+            acc[k] = _mm_add_epi32(acc[k], _mm_madd_epi16(_mm_maddubs_epi16(in, w[k]), ones128()));
+        }
+    }
+    for (unsigned k = 0; k < 8; ++k) {
+        _mm_storeu_si128(reinterpret_cast<vec_t *>(output + 4 * k), acc[k]);
+    }
+#elif defined(SSE2)
+    // no maddubs: widen to 16 bits and keep two partial sums per output,
+    // which are added pairwise at the end
+    const vec_t zeros = _mm_setzero_si128();
+    vec_t acc_lo[8], acc_hi[8];
+    for (unsigned k = 0; k < 8; ++k) {
+        acc_lo[k] = acc_hi[k] = zeros;
+    }
+    for (size_t n = 0; n < count; ++n) {
+        vec_t in = _mm_unpacklo_epi8(_mm_cvtsi32_si128(in32[nnz[n]]), zeros);
+        in = _mm_unpacklo_epi64(in, in);
+        const vec_t *w = reinterpret_cast<const vec_t *>(weights + nnz[n] * chunkWeights);
+        for (unsigned k = 0; k < 8; ++k) {
+            const vec_t w_k = _mm_load_si128(&w[k]);
+            const vec_t signs = _mm_cmpgt_epi8(zeros, w_k);
+            acc_lo[k] = _mm_add_epi32(acc_lo[k], _mm_madd_epi16(_mm_unpacklo_epi8(w_k, signs), in));
+            acc_hi[k] = _mm_add_epi32(acc_hi[k], _mm_madd_epi16(_mm_unpackhi_epi8(w_k, signs), in));
+        }
+    }
+    for (unsigned k = 0; k < 8; ++k) {
+        const __m128 lo = _mm_castsi128_ps(acc_lo[k]);
+        const __m128 hi = _mm_castsi128_ps(acc_hi[k]);
+        vec_t sum = _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0))),
+                                  _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1))));
+        sum = _mm_add_epi32(sum, _mm_loadu_si128(reinterpret_cast<const vec_t *>(biases + 4 * k)));
+        _mm_storeu_si128(reinterpret_cast<vec_t *>(output + 4 * k), sum);
+    }
+#elif defined(NEON)
+    int32x4_t acc[8];
+    for (unsigned k = 0; k < 8; ++k) {
+        acc[k] = vld1q_s32(biases + 4 * k);
+    }
+    for (size_t n = 0; n < count; ++n) {
+        const int8x8_t in = vreinterpret_s8_s32(vdup_n_s32(in32[nnz[n]]));
+        const int8_t *w = weights + nnz[n] * chunkWeights;
+        for (unsigned k = 0; k < 8; ++k) {
+            const int8x16_t w_k = vld1q_s8(w + 16 * k);
+            const int16x8_t p_lo = vmull_s8(in, vget_low_s8(w_k));
+            const int16x8_t p_hi = vmull_s8(in, vget_high_s8(w_k));
+            // pairwise sums, then the widening add finishes the 4 products of each output
+            const int16x8_t pairs = vcombine_s16(vpadd_s16(vget_low_s16(p_lo), vget_high_s16(p_lo)),
+                                                 vpadd_s16(vget_low_s16(p_hi), vget_high_s16(p_hi)));
+            acc[k] = vpadalq_s16(acc[k], pairs);
+        }
+    }
+    for (unsigned k = 0; k < 8; ++k) {
+        vst1q_s32(output + 4 * k, acc[k]);
+    }
+#endif
+}
+
 template <size_t size, typename DataType>
 inline void vec_copy(const DataType *in,DataType *out) {
     assert(in);